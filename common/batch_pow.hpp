@@ -0,0 +1,214 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ZI_BATCH_POW_X86 1
+#endif
+
+#include "modarith.hpp"
+
+// Пакетное возведение в степень для множества независимых (base, exp)
+// по общему модулю. Для нечётных модулей < 2^32 используется арифметика
+// Монтгомери (R = 2^32) в 64-битных дорожках AVX2 (4 дорожки) или
+// AVX-512 (8 дорожек); набор инструкций выбирается во время выполнения.
+// Для остальных модулей и процессоров - скалярный powMod.
+
+namespace zi {
+
+namespace detail {
+
+struct Mont32 {
+    std::uint32_t n;
+    std::uint32_t nInv; // n^{-1} mod 2^32
+    std::uint32_t r2;   // 2^64 mod n
+
+    explicit Mont32(std::uint32_t mod) : n(mod) {
+        nInv = mod;
+        for (int i = 0; i < 4; i++) {
+            nInv *= 2 - mod * nInv;
+        }
+        r2 = static_cast<std::uint32_t>((static_cast<__uint128_t>(1) << 64) % mod);
+    }
+};
+
+inline void batchModPowScalar(const std::uint64_t *bases, const std::uint64_t *exps,
+                              std::size_t count, std::uint64_t mod, std::uint64_t *out) {
+    if (mod % 2 == 1 && mod > 1) {
+        Montgomery mont(mod);
+        for (std::size_t i = 0; i < count; i++) {
+            out[i] = mont.fromMont(mont.pow(mont.toMont(bases[i]), exps[i]));
+        }
+        return;
+    }
+    for (std::size_t i = 0; i < count; i++) {
+        out[i] = powMod(bases[i], exps[i], mod);
+    }
+}
+
+inline int maxBitLength(const std::uint64_t *exps, std::size_t count) {
+    std::uint64_t all = 0;
+    for (std::size_t i = 0; i < count; i++) all |= exps[i];
+    return all == 0 ? 0 : 64 - __builtin_clzll(all);
+}
+
+#ifdef ZI_BATCH_POW_X86
+
+// Монтгомери-умножение в каждой 64-битной дорожке (значения < n < 2^32):
+// t = a*b, q = lo32(t) * n^{-1}, результат hi32(t) - hi32(q*n) (+ n).
+__attribute__((target("avx2")))
+inline __m256i montMul4(__m256i a, __m256i b, __m256i n, __m256i nInv) {
+    __m256i t = _mm256_mul_epu32(a, b);
+    __m256i q = _mm256_mul_epu32(t, nInv);
+    __m256i qn = _mm256_mul_epu32(q, n);
+    __m256i hi = _mm256_sub_epi64(_mm256_srli_epi64(t, 32), _mm256_srli_epi64(qn, 32));
+    __m256i neg = _mm256_cmpgt_epi64(_mm256_setzero_si256(), hi);
+    return _mm256_add_epi64(hi, _mm256_and_si256(neg, n));
+}
+
+__attribute__((target("avx2")))
+inline void batchModPowAvx2(const std::uint64_t *bases, const std::uint64_t *exps,
+                            std::size_t count, std::uint32_t mod, std::uint64_t *out) {
+    Mont32 mont(mod);
+    __m256i n = _mm256_set1_epi64x(mod);
+    __m256i nInv = _mm256_set1_epi64x(mont.nInv);
+    __m256i r2 = _mm256_set1_epi64x(mont.r2);
+    __m256i unit = _mm256_set1_epi64x(1);
+
+    std::size_t i = 0;
+    for (; i + 4 <= count; i += 4) {
+        alignas(32) std::uint64_t b[4];
+        for (int l = 0; l < 4; l++) b[l] = bases[i + l] % mod;
+        __m256i e = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(exps + i));
+        __m256i base = montMul4(_mm256_load_si256(reinterpret_cast<const __m256i *>(b)), r2, n, nInv);
+        __m256i res = montMul4(unit, r2, n, nInv);
+
+        for (int bit = maxBitLength(exps + i, 4) - 1; bit >= 0; bit--) {
+            res = montMul4(res, res, n, nInv);
+            __m256i prod = montMul4(res, base, n, nInv);
+            __m256i set = _mm256_cmpeq_epi64(
+                _mm256_and_si256(_mm256_srli_epi64(e, bit), unit), unit);
+            res = _mm256_blendv_epi8(res, prod, set);
+        }
+        res = montMul4(res, unit, n, nInv);
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(out + i), res);
+    }
+    batchModPowScalar(bases + i, exps + i, count - i, mod, out + i);
+}
+
+// GCC 12 ложно предупреждает о _mm512_undefined_epi32() внутри интринсиков.
+#pragma GCC diagnostic push
+#pragma GCC diagnostic ignored "-Wmaybe-uninitialized"
+
+__attribute__((target("avx512f")))
+inline __m512i montMul8(__m512i a, __m512i b, __m512i n, __m512i nInv) {
+    __m512i t = _mm512_mul_epu32(a, b);
+    __m512i q = _mm512_mul_epu32(t, nInv);
+    __m512i qn = _mm512_mul_epu32(q, n);
+    __m512i th = _mm512_srli_epi64(t, 32);
+    __m512i qh = _mm512_srli_epi64(qn, 32);
+    __mmask8 borrow = _mm512_cmplt_epu64_mask(th, qh);
+    __m512i hi = _mm512_sub_epi64(th, qh);
+    return _mm512_mask_add_epi64(hi, borrow, hi, n);
+}
+
+__attribute__((target("avx512f")))
+inline void batchModPowAvx512(const std::uint64_t *bases, const std::uint64_t *exps,
+                              std::size_t count, std::uint32_t mod, std::uint64_t *out) {
+    Mont32 mont(mod);
+    __m512i n = _mm512_set1_epi64(mod);
+    __m512i nInv = _mm512_set1_epi64(mont.nInv);
+    __m512i r2 = _mm512_set1_epi64(mont.r2);
+    __m512i unit = _mm512_set1_epi64(1);
+
+    std::size_t i = 0;
+    for (; i + 8 <= count; i += 8) {
+        alignas(64) std::uint64_t b[8];
+        for (int l = 0; l < 8; l++) b[l] = bases[i + l] % mod;
+        __m512i e = _mm512_loadu_si512(exps + i);
+        __m512i base = montMul8(_mm512_load_si512(b), r2, n, nInv);
+        __m512i res = montMul8(unit, r2, n, nInv);
+
+        for (int bit = maxBitLength(exps + i, 8) - 1; bit >= 0; bit--) {
+            res = montMul8(res, res, n, nInv);
+            __m512i prod = montMul8(res, base, n, nInv);
+            __mmask8 set = _mm512_test_epi64_mask(_mm512_srli_epi64(e, bit), unit);
+            res = _mm512_mask_mov_epi64(res, set, prod);
+        }
+        res = montMul8(res, unit, n, nInv);
+        _mm512_storeu_si512(out + i, res);
+    }
+    batchModPowAvx2(bases + i, exps + i, count - i, mod, out + i);
+}
+
+#pragma GCC diagnostic pop
+
+#endif // ZI_BATCH_POW_X86
+
+enum class BatchPowKernel { Scalar, Avx2, Avx512 };
+
+inline BatchPowKernel detectBatchPowKernel() {
+#ifdef ZI_BATCH_POW_X86
+    __builtin_cpu_init();
+    if (__builtin_cpu_supports("avx512f")) return BatchPowKernel::Avx512;
+    if (__builtin_cpu_supports("avx2")) return BatchPowKernel::Avx2;
+#endif
+    return BatchPowKernel::Scalar;
+}
+
+} // namespace detail
+
+inline detail::BatchPowKernel batchPowKernel() {
+    static const detail::BatchPowKernel kernel = detail::detectBatchPowKernel();
+    return kernel;
+}
+
+inline const char *batchPowKernelName() {
+    switch (batchPowKernel()) {
+    case detail::BatchPowKernel::Avx512: return "avx512";
+    case detail::BatchPowKernel::Avx2: return "avx2";
+    default: return "scalar";
+    }
+}
+
+// out[i] = bases[i]^exps[i] mod mod, i < count.
+inline void batchModPow(const std::uint64_t *bases, const std::uint64_t *exps,
+                        std::size_t count, std::uint64_t mod, std::uint64_t *out) {
+    if (mod == 0) throw std::invalid_argument("batchModPow: zero modulus");
+#ifdef ZI_BATCH_POW_X86
+    if (mod % 2 == 1 && mod > 1 && mod <= UINT32_MAX) {
+        switch (batchPowKernel()) {
+        case detail::BatchPowKernel::Avx512:
+            detail::batchModPowAvx512(bases, exps, count, static_cast<std::uint32_t>(mod), out);
+            return;
+        case detail::BatchPowKernel::Avx2:
+            detail::batchModPowAvx2(bases, exps, count, static_cast<std::uint32_t>(mod), out);
+            return;
+        default:
+            break;
+        }
+    }
+#endif
+    detail::batchModPowScalar(bases, exps, count, mod, out);
+}
+
+inline std::vector<std::uint64_t> batchModPow(const std::vector<std::uint64_t> &bases,
+                                              const std::vector<std::uint64_t> &exps,
+                                              std::uint64_t mod) {
+    if (bases.size() != exps.size()) throw std::invalid_argument("batchModPow: size mismatch");
+    std::vector<std::uint64_t> out(bases.size());
+    batchModPow(bases.data(), exps.data(), bases.size(), mod, out.data());
+    return out;
+}
+
+// Общий показатель для всех оснований.
+inline std::vector<std::uint64_t> batchModPow(const std::vector<std::uint64_t> &bases,
+                                              std::uint64_t exp, std::uint64_t mod) {
+    return batchModPow(bases, std::vector<std::uint64_t>(bases.size(), exp), mod);
+}
+
+} // namespace zi
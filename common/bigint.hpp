@@ -0,0 +1,101 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <iterator>
+#include <stdexcept>
+#include <vector>
+
+#include <boost/multiprecision/cpp_int.hpp>
+#include <boost/multiprecision/miller_rabin.hpp>
+
+#include "modarith.hpp"
+#include "primes.hpp"
+
+// Многоразрядная арифметика (boost cpp_int) для блочных режимов: перевод
+// между байтами и числами, возведение в степень, обращение, случайные числа
+// и простые числа заданной длины.
+
+namespace zi {
+
+using boost::multiprecision::cpp_int;
+
+inline std::size_t bitLength(const cpp_int &v) {
+    return v == 0 ? 0 : static_cast<std::size_t>(boost::multiprecision::msb(v)) + 1;
+}
+
+inline std::size_t byteLength(const cpp_int &v) {
+    return (bitLength(v) + 7) / 8;
+}
+
+// Беззнаковое число из big-endian байтов.
+inline cpp_int bytesToBig(const std::uint8_t *data, std::size_t count) {
+    cpp_int v = 0;
+    if (count > 0) boost::multiprecision::import_bits(v, data, data + count, 8, true);
+    return v;
+}
+
+// Запись v в width байтов big-endian с ведущими нулями.
+inline void bigToBytes(const cpp_int &v, std::uint8_t *out, std::size_t width) {
+    std::size_t len = byteLength(v);
+    if (len > width) throw std::length_error("bigToBytes: value does not fit");
+    std::fill(out, out + width - len, std::uint8_t(0));
+    if (len > 0) boost::multiprecision::export_bits(v, out + width - len, 8, true);
+}
+
+inline cpp_int powMod(const cpp_int &base, const cpp_int &exp, const cpp_int &mod) {
+    return boost::multiprecision::powm(base, exp, mod);
+}
+
+// 0, если обратного нет.
+inline cpp_int modInverse(const cpp_int &a, const cpp_int &m) {
+    cpp_int x, y;
+    cpp_int g = extendedGCD<cpp_int>(cpp_int(a % m), m, x, y);
+    if (g != 1) return 0;
+    x %= m;
+    if (x < 0) x += m;
+    return x;
+}
+
+// Случайное число из [0, bound) (с запасом 64 бита против смещения).
+template <class Gen>
+cpp_int randomBelow(const cpp_int &bound, Gen &gen) {
+    if (bound <= 0) throw std::invalid_argument("randomBelow: empty range");
+    std::size_t words = (bitLength(bound) + 63) / 64 + 1;
+    cpp_int v = 0;
+    for (std::size_t i = 0; i < words; i++) {
+        v <<= 64;
+        v |= static_cast<std::uint64_t>(gen());
+    }
+    return v % bound;
+}
+
+// Случайное простое ровно из bits битов (два старших бита установлены, чтобы
+// произведение двух таких простых имело 2*bits битов). От случайной нечётной
+// точки кандидаты идут с шагом 2; остатки по малым простым обновляются
+// без деления длинных чисел, Миллер-Рабин - только для прошедших отсев.
+template <class Gen>
+cpp_int randomBigPrime(std::size_t bits, Gen &gen) {
+    if (bits < 16) throw std::invalid_argument("randomBigPrime: too few bits");
+    while (true) {
+        cpp_int base = randomBelow(cpp_int(1) << bits, gen);
+        base |= cpp_int(3) << (bits - 2);
+        base |= 1;
+        std::vector<std::uint32_t> residues;
+        for (std::uint32_t p : smallPrimes) residues.push_back(static_cast<std::uint32_t>(base % p));
+
+        for (std::uint32_t delta = 0; delta < (1u << 16); delta += 2) {
+            bool divisible = false;
+            for (std::size_t i = 0; i < residues.size() && !divisible; i++) {
+                divisible = (residues[i] + delta) % smallPrimes[i] == 0;
+            }
+            if (divisible) continue;
+            cpp_int candidate = base + delta;
+            if (bitLength(candidate) != bits) break;
+            if (boost::multiprecision::miller_rabin_test(candidate, 25, gen)) return candidate;
+        }
+    }
+}
+
+} // namespace zi
@@ -0,0 +1,78 @@
+#pragma once
+
+#include <array>
+#include <cstddef>
+#include <cstdint>
+
+#if defined(__x86_64__) || defined(__i386__)
+#include <immintrin.h>
+#define ZI_BYTE_TABLE_X86 1
+#endif
+
+// Побайтовое преобразование буфера по таблице из 256 значений: data[i] = table[data[i]].
+// На AVX2 таблица разбивается на 16 строк по 16 байт; младший полубайт выбирает
+// элемент строки через pshufb, старший - саму строку (сравнение и смешивание).
+
+namespace zi {
+
+using ByteTable = std::array<std::uint8_t, 256>;
+
+namespace detail {
+
+inline void applyByteTableScalar(const ByteTable &table, std::uint8_t *data, std::size_t count) {
+    for (std::size_t i = 0; i < count; i++) data[i] = table[data[i]];
+}
+
+#ifdef ZI_BYTE_TABLE_X86
+
+__attribute__((target("avx2")))
+inline void applyByteTableAvx2(const ByteTable &table, std::uint8_t *data, std::size_t count) {
+    __m256i rows[16];
+    for (int r = 0; r < 16; r++) {
+        __m128i row = _mm_loadu_si128(reinterpret_cast<const __m128i *>(table.data() + 16 * r));
+        rows[r] = _mm256_broadcastsi128_si256(row);
+    }
+    const __m256i lowMask = _mm256_set1_epi8(0x0F);
+
+    std::size_t i = 0;
+    for (; i + 32 <= count; i += 32) {
+        __m256i v = _mm256_loadu_si256(reinterpret_cast<const __m256i *>(data + i));
+        __m256i lo = _mm256_and_si256(v, lowMask);
+        __m256i hi = _mm256_and_si256(_mm256_srli_epi16(v, 4), lowMask);
+        __m256i res = _mm256_setzero_si256();
+        for (int r = 0; r < 16; r++) {
+            __m256i hit = _mm256_cmpeq_epi8(hi, _mm256_set1_epi8(static_cast<char>(r)));
+            res = _mm256_blendv_epi8(res, _mm256_shuffle_epi8(rows[r], lo), hit);
+        }
+        _mm256_storeu_si256(reinterpret_cast<__m256i *>(data + i), res);
+    }
+    applyByteTableScalar(table, data + i, count - i);
+}
+
+#endif // ZI_BYTE_TABLE_X86
+
+inline bool byteTableHasAvx2() {
+#ifdef ZI_BYTE_TABLE_X86
+    static const bool avx2 = [] {
+        __builtin_cpu_init();
+        return __builtin_cpu_supports("avx2") != 0;
+    }();
+    return avx2;
+#else
+    return false;
+#endif
+}
+
+} // namespace detail
+
+inline void applyByteTable(const ByteTable &table, std::uint8_t *data, std::size_t count) {
+#ifdef ZI_BYTE_TABLE_X86
+    if (detail::byteTableHasAvx2()) {
+        detail::applyByteTableAvx2(table, data, count);
+        return;
+    }
+#endif
+    detail::applyByteTableScalar(table, data, count);
+}
+
+} // namespace zi
@@ -0,0 +1,490 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <climits>
+#include <cmath>
+#include <cstddef>
+#include <cstdint>
+#include <mutex>
+#include <random>
+#include <unordered_map>
+#include <vector>
+
+#include "modarith.hpp"
+#include "parallel.hpp"
+#include "primes.hpp"
+
+// Дискретное логарифмирование: a^x = y (mod p).
+
+namespace zi {
+
+// Таблица шагов младенца: открытая адресация с линейным пробированием.
+// Ключи (вычеты по модулю p) и 32-битные значения хранятся в двух плоских
+// массивах, заполнение не выше 1/2. Массивы либо принадлежат таблице, либо
+// лежат во внешней памяти (например, в отображённом файле), тогда таблица
+// только читается.
+class BabyStepTable {
+public:
+    static constexpr std::uint64_t emptyKey = ~std::uint64_t(0);
+
+    explicit BabyStepTable(std::size_t entries) {
+        std::size_t capacity = 16;
+        while (capacity < 2 * entries) capacity *= 2;
+        ownedKeys_.assign(capacity, emptyKey);
+        ownedValues_.assign(capacity, 0);
+        attach(ownedKeys_.data(), ownedValues_.data(), capacity);
+    }
+
+    // capacity - степень двойки.
+    BabyStepTable(const std::uint64_t *keys, const std::uint32_t *values, std::size_t capacity) {
+        attach(keys, values, capacity);
+    }
+
+    BabyStepTable(const BabyStepTable &) = delete;
+    BabyStepTable &operator=(const BabyStepTable &) = delete;
+    BabyStepTable(BabyStepTable &&) = default;
+    BabyStepTable &operator=(BabyStepTable &&) = default;
+
+    // При повторном ключе значение перезаписывается.
+    void insert(std::uint64_t key, std::uint32_t value) {
+        std::size_t i = slot(key);
+        while (ownedKeys_[i] != emptyKey && ownedKeys_[i] != key) i = (i + 1) & mask_;
+        ownedKeys_[i] = key;
+        ownedValues_[i] = value;
+    }
+
+    // При повторном ключе остаётся первое значение.
+    void insertIfAbsent(std::uint64_t key, std::uint32_t value) {
+        std::size_t i = slot(key);
+        while (ownedKeys_[i] != emptyKey) {
+            if (ownedKeys_[i] == key) return;
+            i = (i + 1) & mask_;
+        }
+        ownedKeys_[i] = key;
+        ownedValues_[i] = value;
+    }
+
+    // Не больше capacity проб: внешняя таблица может не иметь пустых ячеек.
+    bool find(std::uint64_t key, std::uint32_t &value) const {
+        std::size_t i = slot(key);
+        for (std::size_t probes = 0; probes <= mask_ && keys_[i] != emptyKey; probes++) {
+            if (keys_[i] == key) {
+                value = values_[i];
+                return true;
+            }
+            i = (i + 1) & mask_;
+        }
+        return false;
+    }
+
+    std::size_t capacity() const { return mask_ + 1; }
+    const std::uint64_t *keys() const { return keys_; }
+    const std::uint32_t *values() const { return values_; }
+
+    std::size_t memoryBytes() const {
+        return capacity() * (sizeof(std::uint64_t) + sizeof(std::uint32_t));
+    }
+
+private:
+    void attach(const std::uint64_t *keys, const std::uint32_t *values, std::size_t capacity) {
+        keys_ = keys;
+        values_ = values;
+        mask_ = capacity - 1;
+        shift_ = 64 - __builtin_ctzll(capacity);
+    }
+
+    std::size_t slot(std::uint64_t key) const {
+        return static_cast<std::size_t>((key * 0x9E3779B97F4A7C15ULL) >> shift_) & mask_;
+    }
+
+    std::vector<std::uint64_t> ownedKeys_;
+    std::vector<std::uint32_t> ownedValues_;
+    const std::uint64_t *keys_;
+    const std::uint32_t *values_;
+    std::size_t mask_;
+    int shift_;
+};
+
+namespace detail {
+
+// Умножение по модулю p: в форме Монтгомери для нечётных p, иначе через mulMod.
+// Сравнения на равенство в обеих формах эквивалентны.
+class ModField {
+public:
+    explicit ModField(std::uint64_t p)
+        : p_(p), mont_(p % 2 == 1 && p > 1 ? p : 3), useMont_(p % 2 == 1 && p > 1) {}
+
+    std::uint64_t in(std::uint64_t x) const { return useMont_ ? mont_.toMont(x) : x % p_; }
+    std::uint64_t out(std::uint64_t x) const { return useMont_ ? mont_.fromMont(x) : x; }
+    std::uint64_t one() const { return useMont_ ? mont_.one() : 1 % p_; }
+
+    std::uint64_t mul(std::uint64_t a, std::uint64_t b) const {
+        return useMont_ ? mont_.mul(a, b) : mulMod(a, b, p_);
+    }
+
+private:
+    std::uint64_t p_;
+    Montgomery mont_;
+    bool useMont_;
+};
+
+} // namespace detail
+
+// Шаг младенца - шаг великана: таблица y*a^j (j < m), затем поиск a^(i*m),
+// m = sqrt(bound) + 1. Возвращает x = i*m - j либо -1.
+// threads > 1 делит диапазон шагов великана между потоками (0 - по числу
+// ядер); таблица общая и только читается, результат тот же, что и в
+// однопоточном режиме (наименьшее найденное i).
+inline long long babyStepGiantStepBounded(long long a, long long y, long long p, long long bound,
+                                          unsigned threads = 1) {
+    long long m = static_cast<long long>(std::sqrt(static_cast<double>(bound))) + 1;
+    long long k = m;
+
+    detail::ModField field(p);
+    std::uint64_t step = field.in(static_cast<std::uint64_t>(((a % p) + p) % p));
+
+    BabyStepTable table(m);
+    std::uint64_t val = field.in(static_cast<std::uint64_t>(((y % p) + p) % p));
+    for (long long j = 0; j < m; j++) {
+        table.insert(val, static_cast<std::uint32_t>(j));
+        val = field.mul(val, step);
+    }
+
+    std::uint64_t am = field.in(static_cast<std::uint64_t>(modPow(a, m, p)));
+
+    if (resolveThreads(threads) == 1 || k < 4096) {
+        val = field.one();
+        for (long long i = 1; i <= k; i++) {
+            val = field.mul(val, am);
+            std::uint32_t j;
+            if (table.find(val, j)) {
+                return i * m - j;
+            }
+        }
+        return -1;
+    }
+
+    // Куски [begin, end) соответствуют i из [begin + 1, end].
+    std::atomic<long long> bestI(LLONG_MAX);
+    long long bestX = -1;
+    std::mutex bestMutex;
+    parallelFor(static_cast<std::size_t>(k), threads, [&](std::size_t begin, std::size_t end) {
+        long long from = static_cast<long long>(begin) + 1, to = static_cast<long long>(end);
+        std::uint64_t v = field.in(static_cast<std::uint64_t>(modPow(a, (from - 1) * m, p)));
+        for (long long i = from; i <= to; i++) {
+            if ((i & 255) == 0 && bestI.load(std::memory_order_relaxed) < i) return;
+            v = field.mul(v, am);
+            std::uint32_t j;
+            if (table.find(v, j)) {
+                std::lock_guard<std::mutex> lock(bestMutex);
+                if (i < bestI.load()) {
+                    bestI = i;
+                    bestX = i * m - j;
+                }
+                return;
+            }
+        }
+    });
+    return bestX;
+}
+
+inline long long babyStepGiantStepAlt(long long a, long long y, long long p, unsigned threads = 1) {
+    return babyStepGiantStepBounded(a, y, p, p, threads);
+}
+
+namespace detail {
+
+inline std::uint64_t mixHash(std::uint64_t x) {
+    x ^= x >> 31;
+    x *= 0x9E3779B97F4A7C15ULL;
+    return x ^ (x >> 29);
+}
+
+// Доля отмеченных точек 2^-bits: средняя длина прогулки ~ n^(1/4).
+inline int distinguishedBits(std::uint64_t n) {
+    int bits = 64 - __builtin_clzll(n | 1);
+    return bits >= 8 ? bits / 4 : 0;
+}
+
+inline std::uint64_t addMod(std::uint64_t a, std::uint64_t b, std::uint64_t n) {
+    return a >= n - b ? a - (n - b) : a + b;
+}
+
+inline std::uint64_t subMod(std::uint64_t a, std::uint64_t b, std::uint64_t n) {
+    return a >= b ? a - b : a + (n - b);
+}
+
+// Решения coef * x = rhs (mod n), проверяемые подстановкой a^x = y (mod p).
+inline long long solveLogCongruence(long long a, long long y, long long p, std::uint64_t n,
+                                    std::uint64_t coef, std::uint64_t rhs) {
+    long long u, v;
+    std::uint64_t d = static_cast<std::uint64_t>(
+        extendedGCD<long long>(static_cast<long long>(coef), static_cast<long long>(n), u, v));
+    if (d == 0 || rhs % d != 0 || d > (1u << 16)) return -1;
+    std::uint64_t nd = n / d;
+    std::uint64_t inv = nd == 1 ? 0 : modInverse(coef / d % nd, nd);
+    std::uint64_t x0 = nd == 1 ? 0 : mulMod(rhs / d % nd, inv, nd);
+    for (std::uint64_t t = 0; t < d; t++) {
+        long long x = static_cast<long long>(x0 + t * nd);
+        if (modPow(a, x, p) == ((y % p) + p) % p) return x;
+    }
+    return -1;
+}
+
+inline long long trivialLog(long long a, long long y, long long p) {
+    a = ((a % p) + p) % p;
+    y = ((y % p) + p) % p;
+    if (y == 1 % p) return 0;
+    if (a == 0) return y == 0 ? 1 : -1;
+    if (y == 0) return -1;
+    return -2;
+}
+
+inline long long pollardRhoImpl(long long a, long long y, long long p, unsigned threads, int dbits) {
+    const std::uint64_t n = static_cast<std::uint64_t>(p - 1);
+    const std::uint64_t dmask = (std::uint64_t(1) << dbits) - 1;
+    const std::uint64_t maxWalk = std::uint64_t(32) << dbits;
+    const double sqrtN = std::sqrt(static_cast<double>(n));
+    const std::uint64_t budget = static_cast<std::uint64_t>(64.0 * sqrtN) + 4096;
+
+    detail::ModField field(p);
+
+    constexpr int classes = 32;
+    std::uint64_t stepU[classes], stepV[classes], stepM[classes];
+    std::mt19937_64 setup(0x5eed);
+    for (int c = 0; c < classes; c++) {
+        stepU[c] = setup() % n;
+        stepV[c] = setup() % n;
+        stepM[c] = field.in(static_cast<std::uint64_t>(
+            zi::mulMod(modPow(a, stepU[c], p), modPow(y, stepV[c], p), p)));
+    }
+
+    struct Point {
+        std::uint64_t u, v;
+    };
+    std::mutex mutex;
+    std::unordered_map<std::uint64_t, Point> seen;
+    std::atomic<long long> result(-1);
+    std::atomic<std::uint64_t> spent(0);
+
+    parallelTasks(resolveThreads(threads), threads, [&](std::size_t t) {
+        std::mt19937_64 rng(0xC0FFEE + t);
+        while (result.load(std::memory_order_relaxed) == -1 && spent.load() < budget) {
+            std::uint64_t u = rng() % n, v = rng() % n;
+            std::uint64_t x = field.in(static_cast<std::uint64_t>(
+                zi::mulMod(modPow(a, u, p), modPow(y, v, p), p)));
+            std::uint64_t steps = 0;
+            while (steps < maxWalk && (detail::mixHash(x) & dmask) != 0) {
+                int c = static_cast<int>(detail::mixHash(x) >> 59);
+                x = field.mul(x, stepM[c]);
+                u = detail::addMod(u, stepU[c], n);
+                v = detail::addMod(v, stepV[c], n);
+                steps++;
+            }
+            spent += steps + 1;
+            if (steps == maxWalk) continue;
+
+            std::lock_guard<std::mutex> lock(mutex);
+            auto it = seen.find(x);
+            if (it == seen.end()) {
+                seen.emplace(x, Point{u, v});
+                continue;
+            }
+            // a^u y^v = a^u' y^v'  =>  x (v - v') = u' - u (mod n)
+            std::uint64_t coef = detail::subMod(v, it->second.v, n);
+            std::uint64_t rhs = detail::subMod(it->second.u, u, n);
+            if (coef == 0) continue;
+            long long found = detail::solveLogCongruence(a, y, p, n, coef, rhs);
+            if (found != -1) result = found;
+        }
+    });
+    return result.load();
+}
+
+inline long long kangarooImpl(long long a, long long y, long long p, std::uint64_t bound,
+                              unsigned threads, int dbits) {
+    const std::uint64_t n = static_cast<std::uint64_t>(p - 1);
+    const double herd = 2.0 * threads;
+    const double mean = std::max(1.0, herd * std::sqrt(static_cast<double>(bound)) / 4.0);
+    int jumps = 1;
+    while (jumps < 62 && static_cast<double>((std::uint64_t(1) << jumps) - 1) / jumps < mean) jumps++;
+    const std::uint64_t dmask = (std::uint64_t(1) << dbits) - 1;
+    const std::uint64_t budget =
+        static_cast<std::uint64_t>(16.0 * herd * (static_cast<double>(bound) / mean + mean)) + 4096;
+
+    detail::ModField field(p);
+    std::vector<std::uint64_t> jumpM(jumps);
+    for (int i = 0; i < jumps; i++) {
+        jumpM[i] = field.in(static_cast<std::uint64_t>(modPow(a, 1LL << i, p)));
+    }
+
+    struct Trail {
+        bool tame;
+        std::uint64_t dist;
+    };
+    std::mutex mutex;
+    std::unordered_map<std::uint64_t, Trail> seen;
+    std::atomic<long long> result(-1);
+    std::atomic<std::uint64_t> spent(0);
+
+    parallelTasks(resolveThreads(threads), threads, [&](std::size_t t) {
+        std::mt19937_64 rng(0xCAFE + t);
+        auto restart = [&](bool tame, std::uint64_t &pos, std::uint64_t &dist) {
+            std::uint64_t offset = rng() % (bound / 2 + 1);
+            if (tame) {
+                dist = bound / 2 + offset;
+                pos = field.in(static_cast<std::uint64_t>(modPow(a, static_cast<long long>(dist), p)));
+            } else {
+                dist = offset;
+                pos = field.in(static_cast<std::uint64_t>(
+                    zi::mulMod(((y % p) + p) % p, modPow(a, static_cast<long long>(dist), p), p)));
+            }
+        };
+
+        std::uint64_t pos[2], dist[2];
+        restart(true, pos[0], dist[0]);
+        restart(false, pos[1], dist[1]);
+        std::uint64_t local = 0;
+        while (result.load(std::memory_order_relaxed) == -1) {
+            for (int k = 0; k < 2; k++) {
+                int j = static_cast<int>(detail::mixHash(pos[k]) % jumps);
+                pos[k] = field.mul(pos[k], jumpM[j]);
+                dist[k] += std::uint64_t(1) << j;
+                if ((detail::mixHash(pos[k]) & dmask) != 0) continue;
+
+                bool tame = k == 0;
+                std::lock_guard<std::mutex> lock(mutex);
+                auto it = seen.find(pos[k]);
+                if (it == seen.end()) {
+                    seen.emplace(pos[k], Trail{tame, dist[k]});
+                } else if (it->second.tame != tame) {
+                    std::uint64_t dt = tame ? dist[k] : it->second.dist;
+                    std::uint64_t dw = tame ? it->second.dist : dist[k];
+                    std::uint64_t x = detail::subMod(dt % n, dw % n, n);
+                    if (modPow(a, static_cast<long long>(x), p) == ((y % p) + p) % p) {
+                        result = static_cast<long long>(x);
+                    }
+                } else {
+                    // Догнал сородича: дальше пути совпадают, прыгаем заново.
+                    restart(tame, pos[k], dist[k]);
+                }
+            }
+            if (++local == 1024) {
+                if (spent.fetch_add(local) + local > budget) return;
+                local = 0;
+            }
+        }
+    });
+    return result.load();
+}
+
+} // namespace detail
+
+// Ро-метод Полларда с отмеченными точками. Каждый поток ведёт свои прогулки
+// X = a^u * y^v (аддитивное блуждание на 32 классах), хранит только текущую
+// точку и сбрасывает в общую таблицу лишь отмеченные точки. Совпадение двух
+// отмеченных точек с разными v даёт сравнение на x по модулю p-1.
+// Память O(1) на поток плюс ~sqrt(p) * 2^-bits отмеченных точек.
+inline long long pollardRhoLog(long long a, long long y, long long p, unsigned threads = 1) {
+    long long trivial = detail::trivialLog(a, y, p);
+    if (trivial != -2) return trivial;
+
+    std::uint64_t n = static_cast<std::uint64_t>(p - 1);
+    int dbits = detail::distinguishedBits(n);
+    long long x = detail::pollardRhoImpl(a, y, p, threads, dbits);
+    // Орбита элемента малого порядка может не содержать отмеченных точек.
+    if (x == -1 && dbits > 0 && n <= (std::uint64_t(1) << 24)) {
+        x = detail::pollardRhoImpl(a, y, p, threads, 0);
+    }
+    return x;
+}
+
+// Кенгуру Полларда (лямбда-метод) для x из [0, bound); bound = 0 - весь
+// интервал [0, p-1). Ручные кенгуру стартуют с известных степеней a,
+// дикие - с y * a^offset; прыжки - степени двойки со средней длиной
+// N*sqrt(bound)/4 для N кенгуру. В общую таблицу попадают только
+// отмеченные точки; встреча ручного и дикого даёт x = d_tame - d_wild.
+inline long long kangarooLogBounded(long long a, long long y, long long p, std::uint64_t bound,
+                                    unsigned threads = 1) {
+    long long trivial = detail::trivialLog(a, y, p);
+    if (trivial != -2) return trivial;
+
+    std::uint64_t n = static_cast<std::uint64_t>(p - 1);
+    if (bound == 0 || bound > n) bound = n;
+    threads = resolveThreads(threads);
+
+    int dbits = detail::distinguishedBits(bound);
+    long long x = detail::kangarooImpl(a, y, p, bound, threads, dbits);
+    if (x == -1 && dbits > 0 && bound <= (std::uint64_t(1) << 24)) {
+        x = detail::kangarooImpl(a, y, p, bound, threads, 0);
+    }
+    return x;
+}
+
+inline long long kangarooLog(long long a, long long y, long long p, unsigned threads = 1) {
+    return kangarooLogBounded(a, y, p, 0, threads);
+}
+
+// Полиг-Хеллман: порядок a (делитель p-1) раскладывается на множители q^e,
+// логарифм по модулю каждого q^e собирается по q-ичным цифрам, каждая
+// цифра - шаг младенца - шаг великана в подгруппе порядка q, затем всё
+// склеивается по КТО. Стоимость определяется наибольшим простым делителем
+// p-1, а не sqrt(p).
+inline long long pohligHellmanLog(long long a, long long y, long long p, unsigned threads = 1) {
+    long long trivial = detail::trivialLog(a, y, p);
+    if (trivial != -2) return trivial;
+
+    a = ((a % p) + p) % p;
+    y = ((y % p) + p) % p;
+    const std::uint64_t aInv = modInverse(static_cast<std::uint64_t>(a), static_cast<std::uint64_t>(p));
+    if (aInv == 0) return -1;
+
+    // Работаем в подгруппе <a>: n = ord(a), тогда a^(n/q) имеет порядок ровно q.
+    std::uint64_t n = static_cast<std::uint64_t>(p - 1);
+    std::vector<std::pair<std::uint64_t, int>> factors;
+    for (auto [q, e] : factorize(n)) {
+        int k = 0;
+        while (k < e && powMod(static_cast<std::uint64_t>(a), n / q, p) == 1) {
+            n /= q;
+            k++;
+        }
+        if (k < e) factors.push_back({q, e - k});
+    }
+    if (powMod(static_cast<std::uint64_t>(y), n, p) != 1) return -1;
+
+    std::uint64_t x = 0, modulus = 1;
+    for (auto [q, e] : factors) {
+        std::uint64_t qe = 1;
+        for (int i = 0; i < e; i++) qe *= q;
+
+        long long gamma = modPow(a, static_cast<long long>(n / q), p);
+        std::uint64_t xq = 0, qk = 1;
+        for (int k = 0; k < e; k++) {
+            qk *= q;
+            long long shifted = static_cast<long long>(
+                mulMod(static_cast<std::uint64_t>(y), powMod(aInv, xq, p), p));
+            long long h = modPow(shifted, static_cast<long long>(n / qk), p);
+            long long d = 0;
+            if (h != 1) {
+                d = babyStepGiantStepBounded(gamma, h, p, static_cast<long long>(q), threads);
+                if (d < 0) return -1;
+                d %= static_cast<long long>(q);
+            }
+            xq += static_cast<std::uint64_t>(d) * (qk / q);
+        }
+
+        // x = x (mod modulus), x = xq (mod qe)
+        std::uint64_t t = mulMod((xq + qe - x % qe) % qe, modInverse(modulus % qe, qe), qe);
+        x += modulus * t;
+        modulus *= qe;
+    }
+
+    return modPow(a, static_cast<long long>(x), p) == y ? static_cast<long long>(x) : -1;
+}
+
+// Общая сигнатура решателей: babyStepGiantStepAlt, pollardRhoLog, kangarooLog,
+// pohligHellmanLog.
+using DiscreteLogSolver = long long (*)(long long a, long long y, long long p, unsigned threads);
+
+} // namespace zi
@@ -0,0 +1,147 @@
+#pragma once
+
+#include <cmath>
+#include <cstdint>
+#include <cstring>
+#include <fstream>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include "dlog.hpp"
+#include "mapped_file.hpp"
+#include "modarith.hpp"
+
+// Кэш шагов младенца для многих логарифмов по одной паре (a, p).
+// Таблица хранит a^j (j < m) и не зависит от y, поэтому строится один раз,
+// сохраняется в двоичный файл и при следующем запуске отображается в память
+// без перестроения. Каждый запрос y - только шаги великана y * a^(-m*i),
+// их не больше (p-1)/m + 1: чем больше таблица, тем дешевле запрос.
+
+namespace zi {
+
+class BabyStepCache {
+public:
+    // m - число шагов младенца, 0 - sqrt(p) + 1.
+    BabyStepCache(long long a, long long p, long long m = 0)
+        : a_(((a % p) + p) % p), p_(p),
+          m_(m > 0 ? m : static_cast<long long>(std::sqrt(static_cast<double>(p))) + 1),
+          field_(p), table_(static_cast<std::size_t>(m_)) {
+        if (m_ > UINT32_MAX) throw std::invalid_argument("BabyStepCache: too many baby steps");
+        std::uint64_t step = field_.in(static_cast<std::uint64_t>(a_));
+        std::uint64_t val = field_.one();
+        for (long long j = 0; j < m_; j++) {
+            table_.insertIfAbsent(val, static_cast<std::uint32_t>(j));
+            val = field_.mul(val, step);
+        }
+        initGiantStep();
+    }
+
+    static BabyStepCache load(const std::string &path) {
+        auto file = std::make_unique<MappedFile>(path);
+        Header h;
+        if (file->size() < sizeof(Header)) throw std::runtime_error("bsgs cache: truncated file");
+        std::memcpy(&h, file->data(), sizeof(Header));
+        if (std::memcmp(h.magic, magic, sizeof(h.magic)) != 0) {
+            throw std::runtime_error("bsgs cache: bad magic");
+        }
+        if (h.capacity < 16 || (h.capacity & (h.capacity - 1)) != 0 || h.p < 2 || h.a >= h.p ||
+            h.m == 0 || h.m > UINT32_MAX || 2 * h.m > h.capacity ||
+            file->size() != sizeof(Header) + h.capacity * (sizeof(std::uint64_t) + sizeof(std::uint32_t))) {
+            throw std::runtime_error("bsgs cache: corrupted header");
+        }
+        const unsigned char *base = file->data() + sizeof(Header);
+        // Таблица из конструктора заполнена не больше чем на m ячеек из capacity.
+        const std::uint64_t *keys = reinterpret_cast<const std::uint64_t *>(base);
+        std::uint64_t empty = 0;
+        for (std::uint64_t i = 0; i < h.capacity; i++) empty += keys[i] == BabyStepTable::emptyKey;
+        if (empty < h.capacity - h.m) throw std::runtime_error("bsgs cache: corrupted table");
+        BabyStepTable table(keys,
+                            reinterpret_cast<const std::uint32_t *>(base + h.capacity * sizeof(std::uint64_t)),
+                            h.capacity);
+        return BabyStepCache(static_cast<long long>(h.a), static_cast<long long>(h.p),
+                             static_cast<long long>(h.m), std::move(file), std::move(table));
+    }
+
+    void save(const std::string &path) const {
+        std::ofstream out(path, std::ios::binary);
+        if (!out) throw std::runtime_error("cannot write file: " + path);
+        Header h;
+        std::memcpy(h.magic, magic, sizeof(h.magic));
+        h.p = static_cast<std::uint64_t>(p_);
+        h.a = static_cast<std::uint64_t>(a_);
+        h.m = static_cast<std::uint64_t>(m_);
+        h.capacity = table_.capacity();
+        out.write(reinterpret_cast<const char *>(&h), sizeof(h));
+        out.write(reinterpret_cast<const char *>(table_.keys()), h.capacity * sizeof(std::uint64_t));
+        out.write(reinterpret_cast<const char *>(table_.values()), h.capacity * sizeof(std::uint32_t));
+        if (!out) throw std::runtime_error("cannot write file: " + path);
+    }
+
+    long long base() const { return a_; }
+    long long modulus() const { return p_; }
+    long long babySteps() const { return m_; }
+
+    // Наименьший x >= 0 с a^x = y (mod p) либо -1. Таблица могла быть
+    // прочитана из повреждённого файла, поэтому каждый ответ проверяется
+    // возведением в степень; неверные совпадения пропускаются.
+    long long solve(long long y) const {
+        y = ((y % p_) + p_) % p_;
+        if (y == 0) return -1;
+        std::uint64_t val = field_.in(static_cast<std::uint64_t>(y));
+        long long giantSteps = (p_ - 1) / m_ + 1;
+        for (long long i = 0; i < giantSteps; i++) {
+            std::uint32_t j;
+            if (table_.find(val, j) && j < m_) {
+                long long x = i * m_ + j;
+                if (powMod(static_cast<std::uint64_t>(a_), static_cast<std::uint64_t>(x),
+                           static_cast<std::uint64_t>(p_)) == static_cast<std::uint64_t>(y)) {
+                    return x;
+                }
+            }
+            val = field_.mul(val, giant_);
+        }
+        return -1;
+    }
+
+    std::vector<long long> solveAll(const std::vector<long long> &ys, unsigned threads = 1) const {
+        std::vector<long long> xs(ys.size());
+        threads = resolveThreads(threads);
+        parallelTasks(threads, threads, [&](std::size_t t) {
+            for (std::size_t i = t; i < ys.size(); i += threads) xs[i] = solve(ys[i]);
+        });
+        return xs;
+    }
+
+private:
+    struct Header {
+        char magic[8];
+        std::uint64_t p;
+        std::uint64_t a;
+        std::uint64_t m;
+        std::uint64_t capacity;
+    };
+    static constexpr char magic[8] = {'Z', 'I', 'B', 'S', 'G', 'S', '0', '1'};
+
+    BabyStepCache(long long a, long long p, long long m, std::unique_ptr<MappedFile> file,
+                  BabyStepTable table)
+        : a_(a), p_(p), m_(m), field_(p), file_(std::move(file)), table_(std::move(table)) {
+        initGiantStep();
+    }
+
+    void initGiantStep() {
+        std::uint64_t aInv = modInverse(static_cast<std::uint64_t>(a_), static_cast<std::uint64_t>(p_));
+        giant_ = field_.in(powMod(aInv, static_cast<std::uint64_t>(m_), static_cast<std::uint64_t>(p_)));
+    }
+
+    long long a_;
+    long long p_;
+    long long m_;
+    detail::ModField field_;
+    std::uint64_t giant_ = 0;
+    std::unique_ptr<MappedFile> file_;
+    BabyStepTable table_;
+};
+
+} // namespace zi
@@ -0,0 +1,110 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <cstdlib>
+#include <memory>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+#include <fcntl.h>
+#include <openssl/evp.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "mapped_file.hpp"
+
+// SHA-256 через интерфейс EVP (OpenSSL сам выбирает реализацию с SHA-NI/AVX2).
+// Файл по возможности отображается в память; если mmap недоступен (каналы,
+// специальные файлы), читается блоками по 4 МиБ в выровненный буфер.
+
+namespace zi {
+
+class Sha256 {
+public:
+    Sha256() : ctx_(EVP_MD_CTX_new()) {
+        if (!ctx_ || EVP_DigestInit_ex(ctx_, EVP_sha256(), nullptr) != 1) {
+            EVP_MD_CTX_free(ctx_);
+            throw std::runtime_error("EVP sha256 init failed");
+        }
+    }
+
+    Sha256(const Sha256 &) = delete;
+    Sha256 &operator=(const Sha256 &) = delete;
+
+    ~Sha256() { EVP_MD_CTX_free(ctx_); }
+
+    void update(const void *data, std::size_t size) {
+        if (EVP_DigestUpdate(ctx_, data, size) != 1) throw std::runtime_error("EVP sha256 update failed");
+    }
+
+    std::vector<std::uint8_t> final() {
+        std::vector<std::uint8_t> digest(EVP_MAX_MD_SIZE);
+        unsigned int len = 0;
+        if (EVP_DigestFinal_ex(ctx_, digest.data(), &len) != 1) {
+            throw std::runtime_error("EVP sha256 final failed");
+        }
+        digest.resize(len);
+        return digest;
+    }
+
+private:
+    EVP_MD_CTX *ctx_;
+};
+
+namespace detail {
+
+inline void hashDescriptor(int fd, Sha256 &hash) {
+    const std::size_t bufferSize = std::size_t(4) << 20;
+    std::unique_ptr<void, decltype(&std::free)> buffer(std::aligned_alloc(4096, bufferSize), &std::free);
+    if (!buffer) throw std::bad_alloc();
+#ifdef POSIX_FADV_SEQUENTIAL
+    ::posix_fadvise(fd, 0, 0, POSIX_FADV_SEQUENTIAL);
+#endif
+    while (true) {
+        ssize_t got = ::read(fd, buffer.get(), bufferSize);
+        if (got < 0) throw std::runtime_error("read failed");
+        if (got == 0) break;
+        hash.update(buffer.get(), static_cast<std::size_t>(got));
+    }
+}
+
+} // namespace detail
+
+// Путь открывается один раз: повторное open() у именованного канала
+// блокировалось бы в ожидании второго писателя.
+inline std::vector<std::uint8_t> sha256File(const std::string &path) {
+    int fd = ::open(path.c_str(), O_RDONLY);
+    if (fd < 0) throw std::runtime_error("cannot open file: " + path);
+    Sha256 hash;
+    try {
+        struct stat st;
+        if (::fstat(fd, &st) != 0) throw std::runtime_error("cannot stat file: " + path);
+        std::unique_ptr<MappedFile> mapped;
+        if (S_ISREG(st.st_mode) && st.st_size > 0) {
+            try {
+                mapped = std::make_unique<MappedFile>(fd, static_cast<std::size_t>(st.st_size));
+            } catch (const std::runtime_error &) {
+                mapped.reset();
+            }
+        }
+        if (mapped) {
+            mapped->adviseSequential();
+            const std::size_t slice = std::size_t(64) << 20;
+            for (std::size_t pos = 0; pos < mapped->size(); pos += slice) {
+                hash.update(mapped->data() + pos, std::min(slice, mapped->size() - pos));
+            }
+        } else {
+            detail::hashDescriptor(fd, hash);
+        }
+    } catch (...) {
+        ::close(fd);
+        throw;
+    }
+    ::close(fd);
+    return hash.final();
+}
+
+} // namespace zi
@@ -0,0 +1,80 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <vector>
+
+#include "modarith.hpp"
+
+// Возведение фиксированного основания g в степень по предвычисленной таблице:
+// table[i][d] = g^(d * 2^(w*i)). Степень g^e собирается из ceil(bits/w)
+// умножений на элементы таблицы, без единого возведения в квадрат.
+// T - std::uint64_t или cpp_int (для cpp_int умножение идёт через a * b % m).
+
+namespace zi {
+
+namespace detail {
+
+inline std::uint64_t fixedBaseMul(std::uint64_t a, std::uint64_t b, std::uint64_t m) {
+    return mulMod(a, b, m);
+}
+
+template <class T>
+T fixedBaseMul(const T &a, const T &b, const T &m) {
+    return T(a * b % m);
+}
+
+} // namespace detail
+
+template <class T>
+class FixedBasePow {
+public:
+    // order - порядок группы (например, p-1 или q); показатели приводятся по нему,
+    // а размер таблицы определяется его битовой длиной. Порядок должен быть
+    // положительным: с пустой таблицей любая степень давала бы 1.
+    FixedBasePow(const T &g, const T &mod, const T &order, unsigned window = 4)
+        : mod_(mod), order_(order), window_(window) {
+        if (!(order > 0)) throw std::invalid_argument("FixedBasePow: order must be positive");
+        std::size_t bits = 0;
+        for (T t = order; t != 0; t >>= 1) bits++;
+        std::size_t rows = (bits + window_ - 1) / window_;
+        std::size_t cols = (std::size_t(1) << window_) - 1;
+
+        one_ = T(T(1) % mod_);
+        table_.resize(rows, std::vector<T>(cols));
+        T base = T(g % mod_);
+        for (std::size_t i = 0; i < rows; i++) {
+            table_[i][0] = base;
+            for (std::size_t d = 1; d < cols; d++) {
+                table_[i][d] = detail::fixedBaseMul(table_[i][d - 1], base, mod_);
+            }
+            base = detail::fixedBaseMul(table_[i][cols - 1], base, mod_);
+        }
+    }
+
+    const T &modulus() const { return mod_; }
+
+    T pow(T exp) const {
+        exp %= order_;
+        T mask = T((1u << window_) - 1);
+        T res = one_;
+        for (std::size_t i = 0; i < table_.size() && exp != 0; i++) {
+            unsigned digit = static_cast<unsigned>(T(exp & mask));
+            if (digit != 0) {
+                res = detail::fixedBaseMul(res, table_[i][digit - 1], mod_);
+            }
+            exp >>= window_;
+        }
+        return res;
+    }
+
+private:
+    T mod_;
+    T order_;
+    unsigned window_;
+    T one_;
+    std::vector<std::vector<T>> table_;
+};
+
+} // namespace zi
@@ -0,0 +1,39 @@
+#pragma once
+
+#include <fstream>
+#include <sstream>
+#include <stdexcept>
+#include <string>
+#include <vector>
+
+// Манифест пакетной обработки: строка "операция вход выход",
+// пустые строки и строки с # пропускаются.
+
+namespace zi {
+
+struct ManifestJob {
+    std::string op;
+    std::string input;
+    std::string output;
+    int line = 0;
+};
+
+inline std::vector<ManifestJob> readManifest(const std::string &path) {
+    std::ifstream in(path);
+    if (!in) throw std::runtime_error("cannot open manifest: " + path);
+    std::vector<ManifestJob> jobs;
+    std::string text;
+    for (int line = 1; std::getline(in, text); line++) {
+        std::istringstream fields(text);
+        ManifestJob job;
+        if (!(fields >> job.op) || job.op[0] == '#') continue;
+        if (!(fields >> job.input >> job.output)) {
+            throw std::runtime_error(path + ":" + std::to_string(line) + ": expected <op> <input> <output>");
+        }
+        job.line = line;
+        jobs.push_back(job);
+    }
+    return jobs;
+}
+
+} // namespace zi
@@ -0,0 +1,83 @@
+#pragma once
+
+#include <cstddef>
+#include <stdexcept>
+#include <string>
+#include <utility>
+
+#include <fcntl.h>
+#include <sys/mman.h>
+#include <sys/stat.h>
+#include <unistd.h>
+
+// Файл, отображённый в память только для чтения (POSIX mmap).
+
+namespace zi {
+
+class MappedFile {
+public:
+    explicit MappedFile(const std::string &path) {
+        int fd = ::open(path.c_str(), O_RDONLY);
+        if (fd < 0) throw std::runtime_error("cannot open file: " + path);
+        struct stat st;
+        if (::fstat(fd, &st) != 0) {
+            ::close(fd);
+            throw std::runtime_error("cannot stat file: " + path);
+        }
+        try {
+            map(fd, static_cast<std::size_t>(st.st_size));
+        } catch (const std::runtime_error &) {
+            ::close(fd);
+            throw std::runtime_error("cannot mmap file: " + path);
+        }
+        ::close(fd);
+    }
+
+    // Отображение уже открытого дескриптора; fd остаётся у вызывающего.
+    MappedFile(int fd, std::size_t size) { map(fd, size); }
+
+    MappedFile(const MappedFile &) = delete;
+    MappedFile &operator=(const MappedFile &) = delete;
+
+    MappedFile(MappedFile &&other) noexcept
+        : data_(std::exchange(other.data_, nullptr)), size_(std::exchange(other.size_, 0)) {}
+
+    MappedFile &operator=(MappedFile &&other) noexcept {
+        if (this != &other) {
+            unmap();
+            data_ = std::exchange(other.data_, nullptr);
+            size_ = std::exchange(other.size_, 0);
+        }
+        return *this;
+    }
+
+    ~MappedFile() { unmap(); }
+
+    const unsigned char *data() const { return data_; }
+    std::size_t size() const { return size_; }
+
+    // Подсказка ядру для последовательного чтения (упреждающее чтение).
+    void adviseSequential() const {
+        if (data_) ::madvise(const_cast<unsigned char *>(data_), size_, MADV_SEQUENTIAL);
+    }
+
+private:
+    void map(int fd, std::size_t size) {
+        if (size == 0) return;
+        void *p = ::mmap(nullptr, size, PROT_READ, MAP_PRIVATE, fd, 0);
+        if (p == MAP_FAILED) throw std::runtime_error("cannot mmap file");
+        data_ = static_cast<const unsigned char *>(p);
+        size_ = size;
+    }
+
+    void unmap() {
+        if (data_) ::munmap(const_cast<unsigned char *>(data_), size_);
+        data_ = nullptr;
+        size_ = 0;
+    }
+
+    const unsigned char *data_ = nullptr;
+    std::size_t size_ = 0;
+};
+
+} // namespace zi
@@ -0,0 +1,182 @@
+#pragma once
+
+#include <cstddef>
+#include <cstdint>
+#include <stdexcept>
+#include <type_traits>
+#include <utility>
+#include <vector>
+
+// Общая модульная арифметика для лабораторных: умножение по модулю через
+// 128-битные промежуточные значения, форма Монтгомери, возведение в степень
+// скользящим окном и итеративный расширенный алгоритм Евклида.
+
+namespace zi {
+
+inline std::uint64_t mulMod(std::uint64_t a, std::uint64_t b, std::uint64_t m) {
+    return static_cast<std::uint64_t>(static_cast<__uint128_t>(a) * b % m);
+}
+
+// Арифметика Монтгомери по нечётному модулю n < 2^64, R = 2^64.
+class Montgomery {
+public:
+    explicit Montgomery(std::uint64_t n) : n_(n) {
+        nInv_ = n;
+        for (int i = 0; i < 5; i++) {
+            nInv_ *= 2 - n * nInv_;
+        }
+        one_ = (0 - n) % n;
+        r2_ = mulMod(one_, one_, n);
+    }
+
+    std::uint64_t modulus() const { return n_; }
+    std::uint64_t one() const { return one_; }
+
+    std::uint64_t reduce(__uint128_t t) const {
+        std::uint64_t lo = static_cast<std::uint64_t>(t);
+        std::uint64_t hi = static_cast<std::uint64_t>(t >> 64);
+        std::uint64_t q = lo * nInv_;
+        std::uint64_t qn = static_cast<std::uint64_t>((static_cast<__uint128_t>(q) * n_) >> 64);
+        return hi >= qn ? hi - qn : hi - qn + n_;
+    }
+
+    std::uint64_t mul(std::uint64_t a, std::uint64_t b) const {
+        return reduce(static_cast<__uint128_t>(a) * b);
+    }
+
+    std::uint64_t toMont(std::uint64_t a) const {
+        return mul(a % n_, r2_);
+    }
+
+    std::uint64_t fromMont(std::uint64_t a) const {
+        return reduce(a);
+    }
+
+    // base и результат в форме Монтгомери.
+    std::uint64_t pow(std::uint64_t base, std::uint64_t exp) const {
+        if (exp == 0) return one_;
+
+        int bits = 64 - __builtin_clzll(exp);
+        // Показатель не длиннее 64 бит, поэтому окно не шире 3.
+        int w = bits > 24 ? 3 : bits > 6 ? 2 : 1;
+
+        // Нечётные степени base^1, base^3, ..., base^(2^w - 1).
+        std::uint64_t odd[4];
+        odd[0] = base;
+        std::uint64_t base2 = mul(base, base);
+        for (int i = 1; i < (1 << (w - 1)); i++) {
+            odd[i] = mul(odd[i - 1], base2);
+        }
+
+        std::uint64_t res = one_;
+        int i = bits - 1;
+        while (i >= 0) {
+            if (((exp >> i) & 1) == 0) {
+                res = mul(res, res);
+                i--;
+                continue;
+            }
+            int j = i - w + 1 < 0 ? 0 : i - w + 1;
+            while (((exp >> j) & 1) == 0) j++;
+            std::uint64_t window = (exp >> j) & ((1ULL << (i - j + 1)) - 1);
+            for (int k = 0; k < i - j + 1; k++) {
+                res = mul(res, res);
+            }
+            res = mul(res, odd[window >> 1]);
+            i = j - 1;
+        }
+        return res;
+    }
+
+private:
+    std::uint64_t n_;
+    std::uint64_t nInv_;
+    std::uint64_t one_;
+    std::uint64_t r2_;
+};
+
+inline std::uint64_t powMod(std::uint64_t base, std::uint64_t exp, std::uint64_t mod) {
+    if (mod == 1) return 0;
+    if (mod % 2 == 0) {
+        std::uint64_t res = 1;
+        base %= mod;
+        while (exp) {
+            if (exp & 1) res = mulMod(res, base, mod);
+            base = mulMod(base, base, mod);
+            exp >>= 1;
+        }
+        return res;
+    }
+    Montgomery mont(mod);
+    return mont.fromMont(mont.pow(mont.toMont(base), exp));
+}
+
+// Знаковый вариант с сигнатурой, которую используют лабораторные.
+inline long long modPow(long long a, long long n, long long m) {
+    a %= m;
+    if (a < 0) a += m;
+    if (n <= 0) return 1 % m;
+    return static_cast<long long>(powMod(static_cast<std::uint64_t>(a),
+                                         static_cast<std::uint64_t>(n),
+                                         static_cast<std::uint64_t>(m)));
+}
+
+// Итеративный расширенный алгоритм Евклида: a*x + b*y = gcd(a, b).
+// Подходит и для встроенных целых, и для cpp_int; тип выводится по x, y.
+template <class T>
+T extendedGCD(typename std::common_type<T>::type a, typename std::common_type<T>::type b,
+              T &x, T &y) {
+    T x0 = 1, x1 = 0, y0 = 0, y1 = 1;
+    while (b != 0) {
+        T q = a / b;
+        T t = a - q * b;
+        a = std::move(b);
+        b = std::move(t);
+        t = x0 - q * x1;
+        x0 = std::move(x1);
+        x1 = std::move(t);
+        t = y0 - q * y1;
+        y0 = std::move(y1);
+        y1 = std::move(t);
+    }
+    x = std::move(x0);
+    y = std::move(y0);
+    return a;
+}
+
+// 0, если обратного нет.
+inline std::uint64_t modInverse(std::uint64_t a, std::uint64_t m) {
+    __int128 x, y;
+    __int128 g = extendedGCD<__int128>(a % m, m, x, y);
+    if (g != 1) return 0;
+    x %= static_cast<__int128>(m);
+    if (x < 0) x += m;
+    return static_cast<std::uint64_t>(x);
+}
+
+// Пакетное обращение по трюку Монтгомери: одно обращение и 3(N-1) умножений.
+// Бросает std::invalid_argument, если хотя бы один элемент необратим.
+inline std::vector<std::uint64_t> batchModInverse(const std::vector<std::uint64_t> &values,
+                                                  std::uint64_t m) {
+    std::vector<std::uint64_t> result(values.size());
+    if (values.empty()) return result;
+
+    std::vector<std::uint64_t> prefix(values.size());
+    std::uint64_t acc = 1 % m;
+    for (std::size_t i = 0; i < values.size(); i++) {
+        acc = mulMod(acc, values[i] % m, m);
+        prefix[i] = acc;
+    }
+
+    std::uint64_t inv = modInverse(acc, m);
+    if (inv == 0) throw std::invalid_argument("batchModInverse: element is not invertible");
+
+    for (std::size_t i = values.size() - 1; i > 0; i--) {
+        result[i] = mulMod(inv, prefix[i - 1], m);
+        inv = mulMod(inv, values[i] % m, m);
+    }
+    result[0] = inv;
+    return result;
+}
+
+} // namespace zi
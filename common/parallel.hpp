@@ -0,0 +1,109 @@
+#pragma once
+
+#include <algorithm>
+#include <atomic>
+#include <condition_variable>
+#include <cstddef>
+#include <deque>
+#include <exception>
+#include <mutex>
+#include <thread>
+#include <utility>
+#include <vector>
+
+// Простейший параллельный цикл поверх std::thread: диапазон [0, count)
+// делится на непрерывные куски по числу потоков. BoundedQueue - очередь
+// ограниченной ёмкости для конвейеров производитель-потребитель.
+
+namespace zi {
+
+// 0 - по числу аппаратных потоков.
+inline unsigned resolveThreads(unsigned threads) {
+    return threads == 0 ? std::max(1u, std::thread::hardware_concurrency()) : threads;
+}
+
+// fn(begin, end) вызывается для каждого куска; исключение из любого потока
+// пробрасывается вызывающему после завершения остальных.
+template <class Fn>
+void parallelFor(std::size_t count, unsigned threads, Fn &&fn) {
+    threads = resolveThreads(threads);
+    if (threads > count) threads = static_cast<unsigned>(std::max<std::size_t>(count, 1));
+    if (threads == 1) {
+        fn(std::size_t(0), count);
+        return;
+    }
+    std::vector<std::exception_ptr> errors(threads);
+    std::vector<std::thread> pool;
+    std::size_t chunk = (count + threads - 1) / threads;
+    for (unsigned t = 0; t < threads; t++) {
+        std::size_t begin = std::min(count, t * chunk);
+        std::size_t end = std::min(count, begin + chunk);
+        pool.emplace_back([&fn, &errors, t, begin, end] {
+            try {
+                fn(begin, end);
+            } catch (...) {
+                errors[t] = std::current_exception();
+            }
+        });
+    }
+    for (auto &th : pool) th.join();
+    for (auto &e : errors) {
+        if (e) std::rethrow_exception(e);
+    }
+}
+
+// fn(i) для каждого i из [0, count): потоки забирают задачи по одной,
+// поэтому задачи разной длительности распределяются равномерно.
+template <class Fn>
+void parallelTasks(std::size_t count, unsigned threads, Fn &&fn) {
+    std::atomic<std::size_t> nextTask{0};
+    unsigned workers = static_cast<unsigned>(
+        std::min<std::size_t>(resolveThreads(threads), std::max<std::size_t>(count, 1)));
+    parallelFor(workers, workers, [&](std::size_t, std::size_t) {
+        for (std::size_t i = nextTask++; i < count; i = nextTask++) fn(i);
+    });
+}
+
+// push блокируется, пока очередь полна; pop - пока пуста и не закрыта.
+template <class T>
+class BoundedQueue {
+public:
+    explicit BoundedQueue(std::size_t capacity) : capacity_(std::max<std::size_t>(capacity, 1)) {}
+
+    void push(T value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notFull_.wait(lock, [this] { return items_.size() < capacity_ || closed_; });
+        if (closed_) return;
+        items_.push_back(std::move(value));
+        notEmpty_.notify_one();
+    }
+
+    // false - очередь закрыта и опустела.
+    bool pop(T &value) {
+        std::unique_lock<std::mutex> lock(mutex_);
+        notEmpty_.wait(lock, [this] { return !items_.empty() || closed_; });
+        if (items_.empty()) return false;
+        value = std::move(items_.front());
+        items_.pop_front();
+        notFull_.notify_one();
+        return true;
+    }
+
+    // Новые элементы не принимаются, оставшиеся ещё можно забрать.
+    void close() {
+        std::lock_guard<std::mutex> lock(mutex_);
+        closed_ = true;
+        notEmpty_.notify_all();
+        notFull_.notify_all();
+    }
+
+private:
+    std::size_t capacity_;
+    std::deque<T> items_;
+    bool closed_ = false;
+    std::mutex mutex_;
+    std::condition_variable notEmpty_;
+    std::condition_variable notFull_;
+};
+
+} // namespace zi
@@ -0,0 +1,176 @@
+#pragma once
+
+#include <algorithm>
+#include <cstddef>
+#include <cstdint>
+#include <numeric>
+#include <random>
+#include <stdexcept>
+#include <utility>
+#include <vector>
+
+#include "modarith.hpp"
+
+// Проверка простоты 64-битных чисел: отсев малыми простыми и детерминированный
+// тест Миллера-Рабина (базы Синклера покрывают все n < 2^64).
+
+namespace zi {
+
+inline const std::uint32_t smallPrimes[] = {
+    2, 3, 5, 7, 11, 13, 17, 19, 23, 29, 31, 37, 41, 43, 47, 53,
+    59, 61, 67, 71, 73, 79, 83, 89, 97, 101, 103, 107, 109, 113, 127, 131,
+    137, 139, 149, 151, 157, 163, 167, 173, 179, 181, 191, 193, 197, 199, 211, 223,
+    227, 229, 233, 239, 241, 251, 257, 263, 269, 271, 277, 281, 283, 293, 307, 311};
+
+// 1 - простое, 0 - составное, -1 - отсев не дал ответа.
+inline int smallPrimeFilter(std::uint64_t n) {
+    if (n < 2) return 0;
+    for (std::uint32_t p : smallPrimes) {
+        if (n == p) return 1;
+        if (n % p == 0) return 0;
+    }
+    if (n < 313ULL * 313ULL) return 1;
+    return -1;
+}
+
+inline bool millerRabin(std::uint64_t n) {
+    static const std::uint64_t bases[] = {2, 325, 9375, 28178, 450775, 9780504, 1795265022};
+
+    std::uint64_t d = n - 1;
+    int s = __builtin_ctzll(d);
+    d >>= s;
+
+    Montgomery mont(n);
+    std::uint64_t one = mont.one();
+    std::uint64_t minusOne = n - one;
+    for (std::uint64_t a : bases) {
+        a %= n;
+        if (a == 0) continue;
+        std::uint64_t x = mont.pow(mont.toMont(a), d);
+        if (x == one || x == minusOne) continue;
+        bool composite = true;
+        for (int r = 1; r < s; r++) {
+            x = mont.mul(x, x);
+            if (x == minusOne) {
+                composite = false;
+                break;
+            }
+        }
+        if (composite) return false;
+    }
+    return true;
+}
+
+inline bool isPrime(std::uint64_t n) {
+    int filtered = smallPrimeFilter(n);
+    if (filtered >= 0) return filtered == 1;
+    return millerRabin(n);
+}
+
+// Пакетная проверка: сначала весь массив проходит дешёвый отсев,
+// Миллер-Рабин запускается только для оставшихся кандидатов.
+inline std::vector<std::uint8_t> isPrimeBatch(const std::vector<std::uint64_t> &values) {
+    std::vector<std::uint8_t> result(values.size());
+    std::vector<std::size_t> pending;
+    for (std::size_t i = 0; i < values.size(); i++) {
+        int filtered = smallPrimeFilter(values[i]);
+        if (filtered < 0) {
+            pending.push_back(i);
+        } else {
+            result[i] = static_cast<std::uint8_t>(filtered);
+        }
+    }
+    for (std::size_t i : pending) {
+        result[i] = millerRabin(values[i]) ? 1 : 0;
+    }
+    return result;
+}
+
+// Случайное простое из [low, high]: кандидаты проверяются пачками.
+template <class Gen>
+std::uint64_t randomPrime(std::uint64_t low, std::uint64_t high, Gen &gen) {
+    if (low > high) throw std::invalid_argument("randomPrime: low > high");
+    std::uniform_int_distribution<std::uint64_t> dist(low, high);
+    std::vector<std::uint64_t> candidates(64);
+    for (int attempt = 0; attempt < 1000000; attempt++) {
+        for (auto &c : candidates) {
+            c = dist(gen);
+            if (c > 2 && c % 2 == 0 && c < high) c++;
+        }
+        auto flags = isPrimeBatch(candidates);
+        for (std::size_t i = 0; i < candidates.size(); i++) {
+            if (flags[i]) return candidates[i];
+        }
+    }
+    throw std::runtime_error("randomPrime: no prime in range");
+}
+
+// Нетривиальный делитель нечётного составного n (ро-метод Полларда-Брента).
+inline std::uint64_t pollardBrent(std::uint64_t n) {
+    Montgomery mont(n);
+    for (std::uint64_t c = 1;; c++) {
+        std::uint64_t cm = mont.toMont(c);
+        auto f = [&](std::uint64_t x) {
+            std::uint64_t r = mont.mul(x, x) + cm;
+            return r >= n || r < cm ? r - n : r;
+        };
+        std::uint64_t x = mont.toMont(2), y = x, ys = x, q = mont.one(), g = 1;
+        const std::uint64_t m = 128;
+        for (std::uint64_t r = 1; g == 1; r <<= 1) {
+            x = y;
+            for (std::uint64_t i = 0; i < r; i++) y = f(y);
+            for (std::uint64_t k = 0; k < r && g == 1; k += m) {
+                ys = y;
+                for (std::uint64_t i = 0; i < std::min(m, r - k); i++) {
+                    y = f(y);
+                    q = mont.mul(q, x > y ? x - y : y - x);
+                }
+                g = std::gcd(q, n);
+            }
+        }
+        if (g == n) {
+            do {
+                ys = f(ys);
+                g = std::gcd(x > ys ? x - ys : ys - x, n);
+            } while (g == 1);
+        }
+        if (g != n) return g;
+    }
+}
+
+// Разложение на простые множители: (простое, степень) по возрастанию.
+inline std::vector<std::pair<std::uint64_t, int>> factorize(std::uint64_t n) {
+    std::vector<std::uint64_t> primes;
+    for (std::uint32_t p : smallPrimes) {
+        while (n % p == 0) {
+            primes.push_back(p);
+            n /= p;
+        }
+    }
+    std::vector<std::uint64_t> stack;
+    if (n > 1) stack.push_back(n);
+    while (!stack.empty()) {
+        std::uint64_t m = stack.back();
+        stack.pop_back();
+        if (isPrime(m)) {
+            primes.push_back(m);
+            continue;
+        }
+        std::uint64_t d = pollardBrent(m);
+        stack.push_back(d);
+        stack.push_back(m / d);
+    }
+    std::sort(primes.begin(), primes.end());
+
+    std::vector<std::pair<std::uint64_t, int>> result;
+    for (std::uint64_t p : primes) {
+        if (!result.empty() && result.back().first == p) {
+            result.back().second++;
+        } else {
+            result.push_back({p, 1});
+        }
+    }
+    return result;
+}
+
+} // namespace zi
@@ -0,0 +1,86 @@
+// Проверка sha256File на обычном файле, пустом файле и именованном канале.
+// Сборка: g++ -std=c++17 -pthread common/test_file_hash.cpp -lcrypto
+
+#include <cstdio>
+#include <cstdlib>
+#include <fstream>
+#include <iostream>
+#include <string>
+#include <thread>
+#include <vector>
+
+#include <sys/stat.h>
+#include <unistd.h>
+
+#include "file_hash.hpp"
+
+namespace {
+
+int failures = 0;
+
+void check(bool ok, const std::string &what) {
+    std::cout << (ok ? "OK    " : "FAIL  ") << what << std::endl;
+    if (!ok) failures++;
+}
+
+std::vector<std::uint8_t> sha256Bytes(const std::string &data) {
+    zi::Sha256 hash;
+    hash.update(data.data(), data.size());
+    return hash.final();
+}
+
+} // namespace
+
+int main() {
+    // Зависание на канале - тоже ошибка: через 10 с процесс завершается.
+    alarm(10);
+
+    char dirTemplate[] = "/tmp/zi_file_hash_XXXXXX";
+    if (!mkdtemp(dirTemplate)) {
+        std::perror("mkdtemp");
+        return 1;
+    }
+    const std::string dir = dirTemplate;
+
+    std::string data(5 << 20, '\0');
+    for (std::size_t i = 0; i < data.size(); i++) data[i] = static_cast<char>(i * 131 + (i >> 9));
+    const auto expected = sha256Bytes(data);
+
+    const std::string regular = dir + "/regular.bin";
+    std::ofstream(regular, std::ios::binary).write(data.data(), data.size());
+    check(zi::sha256File(regular) == expected, "обычный файл");
+
+    const std::string empty = dir + "/empty.bin";
+    std::ofstream(empty, std::ios::binary).close();
+    check(zi::sha256File(empty) == sha256Bytes(""), "пустой файл");
+
+    const std::string fifo = dir + "/fifo";
+    if (::mkfifo(fifo.c_str(), 0600) != 0) {
+        std::perror("mkfifo");
+        return 1;
+    }
+    std::thread writer([&] { std::ofstream(fifo, std::ios::binary).write(data.data(), data.size()); });
+    bool fifoOk = zi::sha256File(fifo) == expected;
+    writer.join();
+    check(fifoOk, "именованный канал");
+
+    // Писатель успевает закрыть канал: второе open() пути висело бы вечно.
+    std::thread shortWriter([&] { std::ofstream(fifo, std::ios::binary) << "abc"; });
+    bool shortOk = zi::sha256File(fifo) == sha256Bytes("abc");
+    shortWriter.join();
+    check(shortOk, "именованный канал, короткая запись");
+
+    bool missingThrows = false;
+    try {
+        zi::sha256File(dir + "/missing.bin");
+    } catch (const std::runtime_error &) {
+        missingThrows = true;
+    }
+    check(missingThrows, "несуществующий файл");
+
+    std::remove(regular.c_str());
+    std::remove(empty.c_str());
+    std::remove(fifo.c_str());
+    ::rmdir(dir.c_str());
+    return failures == 0 ? 0 : 1;
+}
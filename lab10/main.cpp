@@ -14,6 +14,9 @@
 #include <utility>
 #include <vector>
 
+#include "../common/fixed_base.hpp"
+#include "../common/modarith.hpp"
+
 using boost::multiprecision::cpp_int;
 
 namespace {
@@ -99,16 +102,7 @@ cpp_int mod_pow(cpp_int base, cpp_int exp, const cpp_int &mod) {
 }
 
 cpp_int extended_gcd(const cpp_int &a, const cpp_int &b, cpp_int &x, cpp_int &y) {
-    if (b == 0) {
-        x = 1;
-        y = 0;
-        return a;
-    }
-    cpp_int x1{}, y1{};
-    cpp_int g = extended_gcd(b, a % b, x1, y1);
-    x = y1;
-    y = x1 - (a / b) * y1;
-    return g;
+    return zi::extendedGCD(a, b, x, y);
 }
 
 cpp_int mod_inverse(const cpp_int &a, const cpp_int &mod) {
@@ -272,13 +266,16 @@ GostPrivateKey generate_private_key(std::mt19937_64 &rng) {
     return {params, x, y};
 }
 
-std::pair<cpp_int, cpp_int> sign_message(const std::vector<std::uint8_t> &data,
-                                         const GostPrivateKey &key,
-                                         std::mt19937_64 &rng) {
+// pow_a(k) computes a^k mod p, either directly or from a FixedBasePow table
+template <class PowA>
+std::pair<cpp_int, cpp_int> sign_message_with(const std::vector<std::uint8_t> &data,
+                                              const GostPrivateKey &key,
+                                              PowA &&pow_a,
+                                              std::mt19937_64 &rng) {
     cpp_int h = hash_mod_q(data, key.params.q);
     while (true) {
         cpp_int k = random_range(rng, 1, key.params.q - 1);
-        cpp_int r = mod_pow(key.params.a, k, key.params.p) % key.params.q;
+        cpp_int r = pow_a(k) % key.params.q;
         if (r == 0) continue;
         cpp_int s = (k * h + key.x * r) % key.params.q;
         if (s == 0) continue;
@@ -286,6 +283,20 @@ std::pair<cpp_int, cpp_int> sign_message(const std::vector<std::uint8_t> &data,
     }
 }
 
+std::pair<cpp_int, cpp_int> sign_message(const std::vector<std::uint8_t> &data,
+                                         const GostPrivateKey &key,
+                                         std::mt19937_64 &rng) {
+    return sign_message_with(data, key, [&](const cpp_int &k) { return mod_pow(key.params.a, k, key.params.p); },
+                             rng);
+}
+
+std::pair<cpp_int, cpp_int> sign_message(const std::vector<std::uint8_t> &data,
+                                         const GostPrivateKey &key,
+                                         const zi::FixedBasePow<cpp_int> &a_pow,
+                                         std::mt19937_64 &rng) {
+    return sign_message_with(data, key, [&](const cpp_int &k) { return a_pow.pow(k); }, rng);
+}
+
 bool verify_signature(const std::vector<std::uint8_t> &data,
                       const GostPublicKey &key,
                       const cpp_int &r,
@@ -403,7 +414,7 @@ GostPublicKey parse_public(const std::string &text) {
 void print_usage() {
     std::cout << "Usage:\n"
               << "  gost94 keygen <private_key> <public_key>\n"
-              << "  gost94 sign <private_key> <input_file> <signature_file>\n"
+              << "  gost94 sign <private_key> <input_file> <signature_file> [<input_file> <signature_file> ...]\n"
               << "  gost94 verify <public_key> <input_file> <signature_file>\n";
 }
 
@@ -432,19 +443,33 @@ int main(int argc, char *argv[]) {
             write_text(argv[3], serialize_public(pub));
             std::cout << "keys generated\n";
         } else if (command == "sign") {
-            if (argc != 5) {
+            if (argc < 5 || (argc - 3) % 2 != 0) {
                 print_usage();
                 return 1;
             }
             auto priv_bytes = read_file(argv[2]);
             std::string priv_text(priv_bytes.begin(), priv_bytes.end());
             auto priv = parse_private(priv_text);
-            auto message = read_file(argv[3]);
-            auto [r, s] = sign_message(message, priv, rng);
-            std::ostringstream oss;
-            oss << to_hex(r) << ":" << to_hex(s) << "\n";
-            write_text(argv[4], oss.str());
-            std::cout << "signature written\n";
+            if (argc == 5) {
+                auto message = read_file(argv[3]);
+                auto [r, s] = sign_message(message, priv, rng);
+                std::ostringstream oss;
+                oss << to_hex(r) << ":" << to_hex(s) << "\n";
+                write_text(argv[4], oss.str());
+                std::cout << "signature written\n";
+            } else {
+                // the table costs about two plain exponentiations, so it only
+                // pays off when several messages are signed with one key
+                zi::FixedBasePow<cpp_int> a_pow(priv.params.a, priv.params.p, priv.params.q);
+                for (int i = 3; i + 1 < argc; i += 2) {
+                    auto message = read_file(argv[i]);
+                    auto [r, s] = sign_message(message, priv, a_pow, rng);
+                    std::ostringstream oss;
+                    oss << to_hex(r) << ":" << to_hex(s) << "\n";
+                    write_text(argv[i + 1], oss.str());
+                }
+                std::cout << (argc - 3) / 2 << " signatures written\n";
+            }
         } else if (command == "verify") {
             if (argc != 5) {
                 print_usage();
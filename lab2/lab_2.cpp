@@ -1,55 +1,20 @@
+#include <filesystem>
 #include <iostream>
-#include <cmath>
-#include <unordered_map>
+#include <stdexcept>
+#include <string>
+#include <vector>
 
-long long modPow(long long a, long long n, long long m) {
-    long long res = 1;
-    a %= m;
-    while (n > 0) {
-        if (n % 2 == 1) res = (res * a) % m;
-        a = (a * a) % m;
-        n /= 2;
-    }
-    return res;
-}
-
-long long extendedGCD(long long a, long long b, long long &x, long long &y) {
-    if (b == 0) {
-        x = 1; y = 0;
-        return a;
-    }
-    long long x1, y1;
-    long long gcd = extendedGCD(b, a % b, x1, y1);
-    x = y1;
-    y = x1 - (a / b) * y1;
-    return gcd;
-}
-
-
-long long babyStepGiantStepAlt(long long a, long long y, long long p) {
-    long long m = static_cast<long long>(sqrt(p)) + 1;
-    long long k = m;
-
-    std::unordered_map<long long, long long> table;
-    long long val = y % p;
-    for (long long j = 0; j < m; j++) {
-        table[val] = j;   
-        val = (val * a) % p; 
-    }
+#include "../common/dlog.hpp"
+#include "../common/dlog_cache.hpp"
+#include "../common/modarith.hpp"
 
-    long long am = modPow(a, m, p);
-    val = 1;
-    for (long long i = 1; i <= k; i++) {
-        val = (val * am) % p;       
-        if (table.find(val) != table.end()) {
-            long long j = table[val];
-            long long x = i * m - j;
-            return x;
-        }
-    }
-
-    return -1;
-}
+using zi::modPow;
+using zi::extendedGCD;
+using zi::babyStepGiantStepAlt;
+using zi::pohligHellmanLog;
+using zi::pollardRhoLog;
+using zi::kangarooLog;
+using zi::BabyStepCache;
 
 int main() {
     long long a = 7, y = 57, p = 100;
@@ -67,6 +32,40 @@ int main() {
         std::cout << "Discrete log: x = " << x << std::endl;
     else
         std::cout << "No solution found." << std::endl;
+    std::cout << "Pohlig-Hellman: x = " << pohligHellmanLog(a2, y2, p2) << std::endl;
+    std::cout << "Pohlig-Hellman (p = 257): x = " << pohligHellmanLog(3, 100, 257) << std::endl;
+
+    long long a3 = 3, p3 = 1099511627689LL;
+    long long y3 = modPow(a3, 987654321987LL, p3);
+    x = babyStepGiantStepAlt(a3, y3, p3, 0);
+    std::cout << "Discrete log (p = " << p3 << ", all cores): x = " << x << std::endl;
+
+    std::cout << "Pollard rho: x = " << pollardRhoLog(a3, y3, p3, 0) << std::endl;
+    std::cout << "Kangaroo: x = " << kangarooLog(a3, y3, p3, 0) << std::endl;
+    std::cout << "Pohlig-Hellman: x = " << pohligHellmanLog(a3, y3, p3) << std::endl;
+
+    // Таблица шагов младенца строится один раз и переиспользуется между запусками.
+    // Файл лежит во временном каталоге, а не в текущем.
+    long long a4 = 5, p4 = 1000000007LL;
+    const std::string cachePath = (std::filesystem::temp_directory_path() / "zi_bsgs_cache.bin").string();
+    std::vector<long long> targets;
+    for (long long e : {123456789LL, 987654321LL, 42LL, 999999999LL}) targets.push_back(modPow(a4, e, p4));
+    auto openCache = [&]() {
+        try {
+            BabyStepCache cache = BabyStepCache::load(cachePath);
+            if (cache.base() == a4 && cache.modulus() == p4) {
+                std::cout << "BSGS cache loaded: " << cachePath << std::endl;
+                return cache;
+            }
+        } catch (const std::runtime_error &) {
+        }
+        BabyStepCache cache(a4, p4);
+        cache.save(cachePath);
+        std::cout << "BSGS cache built: " << cachePath << std::endl;
+        return cache;
+    };
+    BabyStepCache cache = openCache();
+    for (long long t : cache.solveAll(targets, 0)) std::cout << "Cached log: x = " << t << std::endl;
 
     return 0;
 }
@@ -1,56 +1,22 @@
+#include <chrono>
+#include <cstdint>
 #include <iostream>
-#include <cmath>
-#include <unordered_map>
-
-long long modPow(long long a, long long n, long long m) {
-    long long res = 1;
-    a %= m;
-    while (n > 0) {
-        if (n % 2 == 1) res = (res * a) % m;
-        a = (a * a) % m;
-        n /= 2;
-    }
-    return res;
-}
-
-long long extendedGCD(long long a, long long b, long long &x, long long &y) {
-    if (b == 0) {
-        x = 1; y = 0;
-        return a;
-    }
-    long long x1, y1;
-    long long gcd = extendedGCD(b, a % b, x1, y1);
-    x = y1;
-    y = x1 - (a / b) * y1;
-    return gcd;
-}
-
-
-long long babyStepGiantStepAlt(long long a, long long y, long long p) {
-    long long m = static_cast<long long>(sqrt(p)) + 1;
-    long long k = m;
-
-    std::unordered_map<long long, long long> table;
-    long long val = y % p;
-    for (long long j = 0; j < m; j++) {
-        table[val] = j;   
-        val = (val * a) % p; 
-    }
-
-    long long am = modPow(a, m, p);
-    val = 1;
-    for (long long i = 1; i <= k; i++) {
-        val = (val * am) % p;       
-        if (table.find(val) != table.end()) {
-            long long j = table[val];
-            long long x = i * m - j;
-            return x;
-        }
-    }
-
-    return -1;
-}
-
+#include <random>
+#include <vector>
+
+#include "../common/modarith.hpp"
+#include "../common/fixed_base.hpp"
+#include "../common/batch_pow.hpp"
+#include "../common/dlog.hpp"
+#include "../common/parallel.hpp"
+
+using zi::modPow;
+using zi::extendedGCD;
+using zi::babyStepGiantStepAlt;
+using zi::pohligHellmanLog;
+
+// Одиночный обмен: таблица FixedBasePow стоит дороже двух обычных возведений,
+// она нужна только пакетному варианту ниже.
 long long diffieHellmanKey(long long g, long long p, long long secretA, long long secretB) {
     long long A = modPow(g, secretA, p);
     long long B = modPow(g, secretB, p); 
@@ -64,6 +30,52 @@ long long diffieHellmanKey(long long g, long long p, long long secretA, long lon
     return keyA; 
 }
 
+// Открытые ключи g^secret для набора сессий; таблица g общая для всех потоков.
+std::vector<std::uint64_t> dhPublicKeys(const zi::FixedBasePow<std::uint64_t> &gPow,
+                                        const std::vector<std::uint64_t> &secrets, unsigned threads = 0) {
+    std::vector<std::uint64_t> keys(secrets.size());
+    zi::parallelFor(secrets.size(), threads, [&](std::size_t begin, std::size_t end) {
+        for (std::size_t i = begin; i < end; i++) keys[i] = gPow.pow(secrets[i]);
+    });
+    return keys;
+}
+
+// Общие секреты peerPublic[i]^secrets[i] mod p (пакетное возведение в степень).
+std::vector<std::uint64_t> dhSharedKeys(const std::vector<std::uint64_t> &peerPublic,
+                                        const std::vector<std::uint64_t> &secrets,
+                                        std::uint64_t p, unsigned threads = 0) {
+    std::vector<std::uint64_t> keys(secrets.size());
+    zi::parallelFor(secrets.size(), threads, [&](std::size_t begin, std::size_t end) {
+        zi::batchModPow(peerPublic.data() + begin, secrets.data() + begin, end - begin, p,
+                        keys.data() + begin);
+    });
+    return keys;
+}
+
+struct DhBatchResult {
+    std::vector<std::uint64_t> keys;
+    std::size_t mismatches = 0;
+    double seconds = 0;
+};
+
+// Пакетный обмен ключами: обе стороны каждой сессии, с проверкой совпадения.
+DhBatchResult diffieHellmanBatch(const zi::FixedBasePow<std::uint64_t> &gPow,
+                                 const std::vector<std::uint64_t> &secretsA,
+                                 const std::vector<std::uint64_t> &secretsB, unsigned threads = 0) {
+    auto start = std::chrono::steady_clock::now();
+    std::uint64_t p = gPow.modulus();
+    DhBatchResult result;
+    std::vector<std::uint64_t> publicA = dhPublicKeys(gPow, secretsA, threads);
+    std::vector<std::uint64_t> publicB = dhPublicKeys(gPow, secretsB, threads);
+    result.keys = dhSharedKeys(publicB, secretsA, p, threads);
+    std::vector<std::uint64_t> keysB = dhSharedKeys(publicA, secretsB, p, threads);
+    for (std::size_t i = 0; i < result.keys.size(); i++) {
+        if (result.keys[i] != keysB[i]) result.mismatches++;
+    }
+    result.seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+    return result;
+}
+
 int main() {
     long long a = 7, y = 57, p = 100;
     long long x, gcdY;
@@ -80,6 +92,8 @@ int main() {
         std::cout << "Discrete log: x = " << x << std::endl;
     else
         std::cout << "No solution found." << std::endl;
+    std::cout << "Pohlig-Hellman: x = " << pohligHellmanLog(a2, y2, p2) << std::endl;
+    std::cout << "Pohlig-Hellman (p = 257): x = " << pohligHellmanLog(3, 100, 257) << std::endl;
 
     long long g = 5, prime = 23;
     long long secretA = 7; 
@@ -88,5 +102,19 @@ int main() {
     long long key = diffieHellmanKey(g, prime, secretA, secretB);
     std::cout << "Общий ключ (DH) = " << key << std::endl;
 
+    const std::uint64_t batchP = 1099511627689ULL, batchG = 3;
+    const std::size_t sessions = 100000;
+    std::mt19937_64 gen(12345);
+    std::uniform_int_distribution<std::uint64_t> dist(2, batchP - 2);
+    std::vector<std::uint64_t> secretsA(sessions), secretsB(sessions);
+    for (std::size_t i = 0; i < sessions; i++) {
+        secretsA[i] = dist(gen);
+        secretsB[i] = dist(gen);
+    }
+    zi::FixedBasePow<std::uint64_t> gPow(batchG, batchP, batchP - 1, 8);
+    DhBatchResult batch = diffieHellmanBatch(gPow, secretsA, secretsB);
+    std::cout << "Пакетный DH: " << sessions << " сессий, несовпадений: " << batch.mismatches
+              << ", " << static_cast<long long>(sessions / batch.seconds) << " обменов/с" << std::endl;
+
     return 0;
 }
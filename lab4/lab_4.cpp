@@ -1,27 +1,24 @@
 #include <iostream>
 #include <fstream>
 #include <cmath>
+#include <cstring>
+#include <exception>
+#include <memory>
+#include <random>
+#include <string>
+#include <thread>
 #include <unordered_map>
+#include <vector>
 
-long long modPow(long long a, long long n, long long m) {
-    long long res = 1;
-    a %= m;
-    while (n > 0) {
-        if (n % 2 == 1) res = (res * a) % m;
-        a = (a * a) % m;
-        n /= 2;
-    }
-    return res;
-}
+#include "../common/batch_pow.hpp"
+#include "../common/bigint.hpp"
+#include "../common/byte_table.hpp"
+#include "../common/modarith.hpp"
+#include "../common/parallel.hpp"
 
-long long extendedGCD(long long a, long long b, long long &x, long long &y) {
-    if (b == 0) { x = 1; y = 0; return a; }
-    long long x1, y1;
-    long long gcd = extendedGCD(b, a % b, x1, y1);
-    x = y1;
-    y = x1 - (a / b) * y1;
-    return gcd;
-}
+using zi::modPow;
+using zi::extendedGCD;
+using zi::cpp_int;
 
 long long modInverse(long long a, long long m) {
     long long x, y;
@@ -30,8 +27,22 @@ long long modInverse(long long a, long long m) {
     return (x % m + m) % m;
 }
 
-void shamirFileProcess(const std::string &inputFile, const std::string &outputFile,
-                       long long exp, long long p) {
+// Для фиксированного показателя проход - отображение байтов, вычисляемое один раз.
+zi::ByteTable shamirByteTable(long long exp, long long p) {
+    std::vector<std::uint64_t> bases(256), powers(256);
+    for (std::size_t b = 0; b < 256; b++) bases[b] = b;
+    zi::batchModPow(bases.data(), std::vector<std::uint64_t>(256, exp).data(), 256, p, powers.data());
+    zi::ByteTable table;
+    for (std::size_t b = 0; b < 256; b++) table[b] = static_cast<std::uint8_t>(powers[b]);
+    return table;
+}
+
+// Все проходы протокола за одно чтение входа: каждый кусок проходит стадии в памяти.
+// steps[s] - файл для результата стадии s (пустое имя - не записывать).
+// threaded - чтение, стадии и запись в отдельных потоках, связанных очередями.
+void shamirPipeline(const std::string &inputFile, const std::string &outputFile,
+                    const std::vector<long long> &exps, long long p,
+                    const std::vector<std::string> &steps = {}, bool threaded = false) {
     std::ifstream in(inputFile, std::ios::binary);
     std::ofstream out(outputFile, std::ios::binary);
 
@@ -40,16 +51,167 @@ void shamirFileProcess(const std::string &inputFile, const std::string &outputFi
         return;
     }
 
-    unsigned char byte;
-    while (in.read(reinterpret_cast<char*>(&byte), 1)) {
-        unsigned char transformed = static_cast<unsigned char>(modPow(byte, exp, p));
-        out.write(reinterpret_cast<char*>(&transformed), 1);
+    std::size_t stages = exps.size();
+    std::vector<zi::ByteTable> tables;
+    std::vector<std::ofstream> stepOut(stages);
+    for (std::size_t s = 0; s < stages; s++) {
+        tables.push_back(shamirByteTable(exps[s], p));
+        if (s < steps.size() && !steps[s].empty()) {
+            stepOut[s].open(steps[s], std::ios::binary);
+            if (!stepOut[s]) {
+                std::cerr << "Ошибка открытия файла: " << steps[s] << std::endl;
+                return;
+            }
+        }
+    }
+
+    const std::size_t chunkSize = 1 << 22;
+    auto readChunk = [&](std::vector<char> &chunk) {
+        chunk.resize(chunkSize);
+        in.read(chunk.data(), chunkSize);
+        chunk.resize(static_cast<std::size_t>(in.gcount()));
+        return !chunk.empty();
+    };
+    auto runStage = [&](std::size_t s, std::vector<char> &chunk) {
+        zi::applyByteTable(tables[s], reinterpret_cast<std::uint8_t *>(chunk.data()), chunk.size());
+        if (stepOut[s].is_open()) stepOut[s].write(chunk.data(), chunk.size());
+    };
+
+    if (!threaded) {
+        std::vector<char> chunk;
+        while (readChunk(chunk)) {
+            for (std::size_t s = 0; s < stages; s++) runStage(s, chunk);
+            out.write(chunk.data(), chunk.size());
+        }
+    } else {
+        using ChunkQueue = zi::BoundedQueue<std::vector<char>>;
+        std::vector<std::unique_ptr<ChunkQueue>> queues;
+        for (std::size_t s = 0; s <= stages; s++) queues.push_back(std::make_unique<ChunkQueue>(4));
+
+        std::vector<std::thread> workers;
+        workers.emplace_back([&] {
+            std::vector<char> chunk;
+            while (readChunk(chunk)) queues[0]->push(std::move(chunk));
+            queues[0]->close();
+        });
+        for (std::size_t s = 0; s < stages; s++) {
+            workers.emplace_back([&, s] {
+                std::vector<char> chunk;
+                while (queues[s]->pop(chunk)) {
+                    runStage(s, chunk);
+                    queues[s + 1]->push(std::move(chunk));
+                }
+                queues[s + 1]->close();
+            });
+        }
+        std::vector<char> chunk;
+        while (queues[stages]->pop(chunk)) out.write(chunk.data(), chunk.size());
+        for (auto &th : workers) th.join();
     }
 
     std::cout << "Файл обработан: " << outputFile << std::endl;
 }
 
-int main() {
+// Блочный режим: элемент - число из blockBytes байтов по большому простому p.
+// Контейнер: заголовок (метка, длина исходных данных, blockBytes, ширина
+// элемента), затем элементы по width байтов big-endian. Блоки независимы
+// и обрабатываются пачками на пуле потоков.
+struct ShamirBlockHeader {
+    char magic[8];
+    std::uint64_t length;
+    std::uint32_t blockBytes;
+    std::uint32_t width;
+};
+
+const char shamirBlockMagic[8] = {'Z', 'I', 'S', 'H', 'M', 'R', '0', '1'};
+
+// Простое Мерсенна 2^521 - 1: 65 байтов данных на элемент.
+cpp_int shamirBlockPrime() {
+    return (cpp_int(1) << 521) - 1;
+}
+
+// Случайный показатель c, взаимно простой с p - 1, и обратный к нему d.
+std::pair<cpp_int, cpp_int> shamirBlockKey(const cpp_int &p, std::mt19937_64 &gen) {
+    while (true) {
+        cpp_int c = zi::randomBelow(p - 4, gen) + 3;
+        cpp_int d = zi::modInverse(c, p - 1);
+        if (d != 0) return {c, d};
+    }
+}
+
+// plainIn/plainOut - вход/выход в виде исходных байтов, иначе контейнер.
+bool shamirBlockProcess(const std::string &inputFile, const std::string &outputFile,
+                        const cpp_int &exp, const cpp_int &p, bool plainIn, bool plainOut,
+                        unsigned threads = 0) {
+    std::ifstream in(inputFile, std::ios::binary);
+    std::ofstream out(outputFile, std::ios::binary);
+
+    if (!in || !out) {
+        std::cerr << "Ошибка открытия файлов: " << inputFile << " или " << outputFile << std::endl;
+        return false;
+    }
+
+    ShamirBlockHeader header;
+    std::memcpy(header.magic, shamirBlockMagic, sizeof(header.magic));
+    header.blockBytes = static_cast<std::uint32_t>((zi::bitLength(p) - 1) / 8);
+    header.width = static_cast<std::uint32_t>(zi::byteLength(p));
+    if (plainIn) {
+        in.seekg(0, std::ios::end);
+        header.length = static_cast<std::uint64_t>(in.tellg());
+        in.seekg(0, std::ios::beg);
+    } else {
+        ShamirBlockHeader stored;
+        if (!in.read(reinterpret_cast<char *>(&stored), sizeof(stored)) ||
+            std::memcmp(stored.magic, shamirBlockMagic, sizeof(stored.magic)) != 0 ||
+            stored.blockBytes != header.blockBytes || stored.width != header.width) {
+            std::cerr << "Неверный формат блочного файла: " << inputFile << std::endl;
+            return false;
+        }
+        header.length = stored.length;
+    }
+    if (!plainOut) out.write(reinterpret_cast<const char *>(&header), sizeof(header));
+
+    const std::size_t inUnit = plainIn ? header.blockBytes : header.width;
+    const std::size_t outUnit = plainOut ? header.blockBytes : header.width;
+    const std::size_t batchBlocks = 1024;
+    std::uint64_t blocksLeft = (header.length + header.blockBytes - 1) / header.blockBytes;
+    std::uint64_t bytesLeft = header.length;
+    std::vector<std::uint8_t> inBuf(batchBlocks * inUnit), outBuf(batchBlocks * outUnit);
+
+    try {
+        while (blocksLeft > 0) {
+            std::size_t blocks = static_cast<std::size_t>(std::min<std::uint64_t>(blocksLeft, batchBlocks));
+            std::size_t want = plainIn ? static_cast<std::size_t>(std::min<std::uint64_t>(bytesLeft, blocks * inUnit))
+                                       : blocks * inUnit;
+            std::fill(inBuf.begin(), inBuf.end(), std::uint8_t(0));
+            if (!in.read(reinterpret_cast<char *>(inBuf.data()), want)) {
+                std::cerr << "Файл обрезан: " << inputFile << std::endl;
+                return false;
+            }
+
+            zi::parallelFor(blocks, threads, [&](std::size_t begin, std::size_t end) {
+                for (std::size_t i = begin; i < end; i++) {
+                    cpp_int v = zi::bytesToBig(inBuf.data() + i * inUnit, inUnit);
+                    zi::bigToBytes(zi::powMod(v, exp, p), outBuf.data() + i * outUnit, outUnit);
+                }
+            });
+
+            std::size_t produced = blocks * outUnit;
+            if (plainOut) produced = static_cast<std::size_t>(std::min<std::uint64_t>(bytesLeft, produced));
+            out.write(reinterpret_cast<const char *>(outBuf.data()), produced);
+            blocksLeft -= blocks;
+            bytesLeft -= std::min<std::uint64_t>(bytesLeft, blocks * header.blockBytes);
+        }
+    } catch (const std::exception &e) {
+        std::cerr << "Ошибка блочной обработки " << inputFile << ": " << e.what() << std::endl;
+        return false;
+    }
+
+    std::cout << "Файл обработан: " << outputFile << std::endl;
+    return true;
+}
+
+int main(int argc, char *argv[]) {
     long long a = 7, y = 57, p = 100;
     std::cout << a << "^" << 5 << " mod " << p << " = " << modPow(a, 5, p) << std::endl;
 
@@ -69,9 +231,27 @@ int main() {
     long long dA = modInverse(cA, pFile - 1);
     long long dB = modInverse(cB, pFile - 1);
 
-    shamirFileProcess(input, step1, cA, pFile); 
-    shamirFileProcess(step1, step2, cB, pFile);
-    shamirFileProcess(step2, step3, dA, pFile);  
-    shamirFileProcess(step3, output, dB, pFile);  
+    bool threaded = false, keepSteps = false, blockMode = false;
+    for (int i = 1; i < argc; i++) {
+        std::string arg = argv[i];
+        if (arg == "--threads") threaded = true;
+        if (arg == "--keep-steps") keepSteps = true;
+        if (arg == "--blocks") blockMode = true;
+    }
+
+    if (blockMode) {
+        cpp_int bigP = shamirBlockPrime();
+        std::mt19937_64 gen(std::random_device{}());
+        auto [bigCA, bigDA] = shamirBlockKey(bigP, gen);
+        auto [bigCB, bigDB] = shamirBlockKey(bigP, gen);
+        bool ok = shamirBlockProcess(input, step1, bigCA, bigP, true, false) &&
+                  shamirBlockProcess(step1, step2, bigCB, bigP, false, false) &&
+                  shamirBlockProcess(step2, step3, bigDA, bigP, false, false) &&
+                  shamirBlockProcess(step3, output, bigDB, bigP, false, true);
+        return ok ? 0 : 1;
+    }
+    std::vector<std::string> steps;
+    if (keepSteps) steps = {step1, step2, step3};
+    shamirPipeline(input, output, {cA, cB, dA, dB}, pFile, steps, threaded);
     return 0;
 }
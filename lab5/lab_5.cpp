@@ -1,53 +1,364 @@
 #include <iostream>
+#include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <cstdint>
+#include <cstring>
 #include <fstream>
+#include <memory>
+#include <optional>
+#include <random>
+#include <string>
+#include <utility>
 #include <vector>
 
+#include <fcntl.h>
+#include <unistd.h>
+
+#include "../common/modarith.hpp"
+#include "../common/fixed_base.hpp"
+#include "../common/bigint.hpp"
+#include "../common/manifest.hpp"
+#include "../common/parallel.hpp"
+
 using namespace std;
+using zi::modPow;
+using zi::cpp_int;
+
+// Двоичный шифртекст: метка, ширина элемента в байтах, размер блока
+// открытого текста (0 - побайтовый режим), p и g, затем пары (r, e)
+// фиксированной ширины. Все поля big-endian, файл не зависит от хоста.
+// Версия 001 хранила два поля заголовка в порядке хоста; такие файлы
+// (их писали x86-машины) читаются как little-endian.
+const char cipherMagic[8] = {'Z', 'I', 'E', 'L', 'G', '0', '0', '2'};
+const char cipherMagicV1[8] = {'Z', 'I', 'E', 'L', 'G', '0', '0', '1'};
+
+void putU32(uint8_t *out, uint32_t v, bool bigEndian = true) {
+    for (int i = 0; i < 4; i++) out[bigEndian ? 3 - i : i] = static_cast<uint8_t>(v >> (8 * i));
+}
+
+uint32_t getU32(const uint8_t *in, bool bigEndian = true) {
+    uint32_t v = 0;
+    for (int i = 0; i < 4; i++) v |= uint32_t(in[bigEndian ? 3 - i : i]) << (8 * i);
+    return v;
+}
+
+uint32_t elementWidth(uint64_t p) {
+    uint32_t width = 1;
+    while (width < 8 && (p >> (8 * width)) != 0) width++;
+    return width;
+}
+
+class CipherWriter {
+public:
+    CipherWriter(const string &path, uint64_t p, uint64_t g, uint32_t blockBytes = 0)
+        : out_(path, ios::binary), width_(elementWidth(p)) {
+        writeHeader(blockBytes);
+        put(p);
+        put(g);
+    }
+
+    CipherWriter(const string &path, const cpp_int &p, const cpp_int &g, uint32_t blockBytes)
+        : out_(path, ios::binary), width_(static_cast<uint32_t>(zi::byteLength(p))) {
+        writeHeader(blockBytes);
+        put(p);
+        put(g);
+    }
+
+    ~CipherWriter() { flush(); }
+
+    bool ok() const { return static_cast<bool>(out_); }
+
+    void writePair(uint64_t r, uint64_t e) {
+        put(r);
+        put(e);
+        if (buffer_.size() >= bufferSize) flush();
+    }
+
+    void writePair(const cpp_int &r, const cpp_int &e) {
+        put(r);
+        put(e);
+        if (buffer_.size() >= bufferSize) flush();
+    }
+
+    void flush() {
+        out_.write(reinterpret_cast<const char *>(buffer_.data()), buffer_.size());
+        buffer_.clear();
+        out_.flush();
+    }
+
+private:
+    static const size_t bufferSize = 1 << 20;
+
+    void writeHeader(uint32_t blockBytes) {
+        out_.write(cipherMagic, sizeof(cipherMagic));
+        uint8_t fields[8];
+        putU32(fields, width_);
+        putU32(fields + 4, blockBytes);
+        out_.write(reinterpret_cast<const char *>(fields), sizeof(fields));
+    }
+
+    void put(uint64_t v) {
+        for (uint32_t i = width_; i-- > 0;) buffer_.push_back(static_cast<uint8_t>(v >> (8 * i)));
+    }
+
+    void put(const cpp_int &v) {
+        size_t pos = buffer_.size();
+        buffer_.resize(pos + width_);
+        zi::bigToBytes(v, buffer_.data() + pos, width_);
+    }
+
+    ofstream out_;
+    uint32_t width_;
+    vector<uint8_t> buffer_;
+};
+
+class CipherReader {
+public:
+    explicit CipherReader(const string &path) : in_(path, ios::binary) {
+        char magic[sizeof(cipherMagic)];
+        uint8_t fields[8];
+        if (!in_.read(magic, sizeof(magic)) ||
+            !in_.read(reinterpret_cast<char *>(fields), sizeof(fields))) {
+            valid_ = false;
+            return;
+        }
+        bool current = memcmp(magic, cipherMagic, sizeof(magic)) == 0;
+        if (!current && memcmp(magic, cipherMagicV1, sizeof(magic)) != 0) {
+            valid_ = false;
+            return;
+        }
+        width_ = getU32(fields, current);
+        blockBytes_ = getU32(fields + 4, current);
+        if (width_ == 0) {
+            valid_ = false;
+            return;
+        }
+        valid_ = get(p_) && get(g_);
+    }
+
+    // false - файл не в двоичном формате (или повреждён заголовок).
+    bool valid() const { return valid_; }
+    const cpp_int &p() const { return p_; }
+    const cpp_int &g() const { return g_; }
+    uint32_t blockBytes() const { return blockBytes_; }
 
-long long modPow(long long a, long long n, long long m) {
-    long long res = 1;
-    a %= m;
-    while (n > 0) {
-        if (n % 2 == 1)
-            res = (res * a) % m;
-        a = (a * a) % m;
-        n /= 2;
+    // Только для ширины элемента до 8 байтов (побайтовый режим).
+    bool readPair(uint64_t &r, uint64_t &e) {
+        const uint8_t *a, *b;
+        if (width_ > 8 || !next(a) || !next(b)) return false;
+        r = e = 0;
+        for (uint32_t i = 0; i < width_; i++) {
+            r = (r << 8) | a[i];
+            e = (e << 8) | b[i];
+        }
+        return true;
     }
-    return res;
+
+    bool readPair(cpp_int &r, cpp_int &e) {
+        return get(r) && get(e);
+    }
+
+private:
+    static const size_t bufferSize = 1 << 20;
+
+    // Указатель на следующий элемент (действителен до следующего вызова).
+    bool next(const uint8_t *&element) {
+        if (pos_ + width_ > buffer_.size()) {
+            buffer_.erase(buffer_.begin(), buffer_.begin() + pos_);
+            pos_ = 0;
+            size_t kept = buffer_.size();
+            buffer_.resize(kept + max<size_t>(bufferSize, 2 * width_));
+            in_.read(reinterpret_cast<char *>(buffer_.data() + kept), buffer_.size() - kept);
+            buffer_.resize(kept + static_cast<size_t>(in_.gcount()));
+            if (buffer_.size() < width_) return false;
+        }
+        element = buffer_.data() + pos_;
+        pos_ += width_;
+        return true;
+    }
+
+    bool get(cpp_int &v) {
+        const uint8_t *element;
+        if (!next(element)) return false;
+        v = zi::bytesToBig(element, width_);
+        return true;
+    }
+
+    ifstream in_;
+    bool valid_ = false;
+    uint32_t width_ = 0;
+    uint32_t blockBytes_ = 0;
+    cpp_int p_ = 0;
+    cpp_int g_ = 0;
+    vector<uint8_t> buffer_;
+    size_t pos_ = 0;
+};
+
+// 64 бита из random_device на каждый вызов (без детерминированного состояния).
+struct DeviceRandom {
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    random_device rd;
+    result_type operator()() { return (uint64_t(rd()) << 32) | rd(); }
+};
+
+// mt19937_64, всё состояние которого засеяно из random_device (а не одним
+// 32-битным числом, которое перебирается за 2^32 попыток). Быстрее
+// DeviceRandom, поэтому годится для побайтового режима.
+struct SeededRandom {
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    SeededRandom() {
+        random_device rd;
+        vector<uint32_t> words(mt19937_64::state_size * 2);
+        generate(words.begin(), words.end(), ref(rd));
+        seed_seq seq(words.begin(), words.end());
+        gen.seed(seq);
+    }
+
+    result_type operator()() { return gen(); }
+
+    mt19937_64 gen;
+};
+
+// Случайный показатель k из [2, p - 2].
+template <class Gen>
+uint64_t randomExponent(uint64_t p, Gen &gen) {
+    return uniform_int_distribution<uint64_t>(2, p - 2)(gen);
 }
 
+template <class Gen>
+cpp_int randomExponent(const cpp_int &p, Gen &gen) {
+    return zi::randomBelow(cpp_int(p - 3), gen) + 2;
+}
+
+// Запас одноразовых пар (g^k, dB^k): пары считаются пачками на пуле потоков
+// заранее, шифрование блока берёт готовую пару без возведений в степень.
+// Таблицы степеней g и dB можно построить один раз и отдать нескольким запасам.
+// Gen - источник показателей k (SeededRandom или DeviceRandom).
+template <class T, class Gen = SeededRandom>
+class EphemeralPool {
+public:
+    using Table = shared_ptr<const zi::FixedBasePow<T>>;
+
+    EphemeralPool(const T &p, const T &g, const T &dB, size_t batch = 1024, unsigned threads = 0)
+        : EphemeralPool(p, make_shared<const zi::FixedBasePow<T>>(g, p, T(p - 1)),
+                        make_shared<const zi::FixedBasePow<T>>(dB, p, T(p - 1)), batch, threads) {}
+
+    EphemeralPool(const T &p, Table gPow, Table dPow, size_t batch, unsigned threads)
+        : p_(p), gPow_(move(gPow)), dPow_(move(dPow)), batch_(max<size_t>(batch, 1)), threads_(threads) {}
+
+    pair<T, T> next() {
+        if (pos_ == pairs_.size()) refill();
+        return pairs_[pos_++];
+    }
+
+    size_t generated() const { return generated_; }
+
+private:
+    void refill() {
+        vector<T> ks(batch_);
+        for (auto &k : ks) k = randomExponent(p_, gen_);
+        pairs_.resize(batch_);
+        zi::parallelFor(batch_, threads_, [&](size_t begin, size_t end) {
+            for (size_t i = begin; i < end; i++) pairs_[i] = {gPow_->pow(ks[i]), dPow_->pow(ks[i])};
+        });
+        pos_ = 0;
+        generated_ += batch_;
+    }
+
+    T p_;
+    Table gPow_;
+    Table dPow_;
+    size_t batch_;
+    unsigned threads_;
+    Gen gen_;
+    vector<pair<T, T>> pairs_;
+    size_t pos_ = 0;
+    size_t generated_ = 0;
+};
+
+// Кэш r -> r^(p-1-x) с прямым отображением: при общем k все r совпадают.
+class InverseCache {
+public:
+    InverseCache(uint64_t p, uint64_t x) : p_(p), exp_(p - 1 - x), slots_(size) {}
+
+    uint64_t get(uint64_t r) {
+        Slot &slot = slots_[r & (size - 1)];
+        lookups_++;
+        if (slot.valid && slot.r == r) {
+            hits_++;
+            return slot.value;
+        }
+        slot = {r, zi::powMod(r, exp_, p_), true};
+        return slot.value;
+    }
+
+    size_t lookups() const { return lookups_; }
+    size_t hits() const { return hits_; }
+
+private:
+    static const size_t size = 4096;
 
-void encryptFile(const string &inputFile, const string &outputFile,
+    struct Slot {
+        uint64_t r = 0;
+        uint64_t value = 0;
+        bool valid = false;
+    };
+
+    uint64_t p_;
+    uint64_t exp_;
+    vector<Slot> slots_;
+    size_t lookups_ = 0;
+    size_t hits_ = 0;
+};
+
+// k > 0 - общий k для всего файла (g^k и dB^k считаются один раз),
+// k = 0 - свой k для каждого байта из запаса EphemeralPool. Пары по 64-битному
+// модулю дешёвые, поэтому запас пополняется в одном потоке (в пакетном режиме
+// файлы и так шифруются параллельно).
+bool encryptFile(const string &inputFile, const string &outputFile,
                  long long p, long long g, long long dB, long long k) {
     ifstream in(inputFile, ios::binary);
-    ofstream out(outputFile);
+    CipherWriter out(outputFile, p, g);
 
-    if (!in.is_open() || !out.is_open()) {
+    if (!in.is_open() || !out.ok()) {
         cerr << "Ошибка открытия файла!" << endl;
-        return;
+        return false;
+    }
+
+    optional<EphemeralPool<uint64_t>> pool;
+    uint64_t r = 0, dk = 0;
+    if (k > 0) {
+        r = modPow(g, k, p);
+        dk = modPow(dB, k, p);
+    } else {
+        pool.emplace(p, g, dB, 1 << 14, 1);
     }
 
-    unsigned char byte;
-    while (in.read((char*)&byte, 1)) {
-        long long m = byte; 
-        long long r = modPow(g, k, p);
-        long long e = (m * modPow(dB, k, p)) % p;
-        out << r << " " << e << "\n";
+    vector<char> buffer(1 << 16);
+    while (in.read(buffer.data(), buffer.size()) || in.gcount() > 0) {
+        size_t count = static_cast<size_t>(in.gcount());
+        for (size_t i = 0; i < count; i++) {
+            if (pool) tie(r, dk) = pool->next();
+            uint64_t m = static_cast<unsigned char>(buffer[i]);
+            out.writePair(r, m * dk % p);
+        }
     }
 
+    if (pool) cout << "Сгенерировано пар (g^k, dB^k): " << pool->generated() << endl;
     cout << "Файл " << inputFile << " зашифрован в " << outputFile << endl;
+    return true;
 }
 
-void decryptFile(const string &inputFile, const string &outputFile,
-                 long long p, long long xB) {
+// Старый текстовый формат "r e" построчно.
+void decryptTextFile(const string &inputFile, ofstream &out, long long p, long long xB) {
     ifstream in(inputFile);
-    ofstream out(outputFile, ios::binary);
-
-    if (!in.is_open() || !out.is_open()) {
-        cerr << "Ошибка открытия файла!" << endl;
-        return;
-    }
-
     long long r, e;
     while (in >> r >> e) {
         long long r_inv = modPow(r, p - 1 - xB, p);
@@ -55,15 +366,215 @@ void decryptFile(const string &inputFile, const string &outputFile,
         unsigned char byte = static_cast<unsigned char>(m);
         out.write((char*)&byte, 1);
     }
+}
+
+bool decryptFile(const string &inputFile, const string &outputFile,
+                 long long p, long long xB) {
+    CipherReader in(inputFile);
+    ofstream out(outputFile, ios::binary);
+
+    if (!ifstream(inputFile).is_open() || !out.is_open()) {
+        cerr << "Ошибка открытия файла!" << endl;
+        return false;
+    }
+
+    if (!in.valid()) {
+        decryptTextFile(inputFile, out, p, xB);
+    } else {
+        if (in.p() != p || in.blockBytes() != 0) {
+            cerr << "Файл зашифрован с другим p = " << in.p() << " или в блочном режиме" << endl;
+            return false;
+        }
+        InverseCache cache(p, xB);
+        vector<char> buffer;
+        uint64_t r, e;
+        while (in.readPair(r, e)) {
+            long long r_inv = cache.get(r);
+            long long m = (static_cast<long long>(e) * r_inv) % p;
+            buffer.push_back(static_cast<char>(m));
+            if (buffer.size() == (1 << 16)) {
+                out.write(buffer.data(), buffer.size());
+                buffer.clear();
+            }
+        }
+        out.write(buffer.data(), buffer.size());
+        cout << "Кэш r^(-x): попаданий " << cache.hits() << " из " << cache.lookups() << endl;
+    }
+
+    cout << "Файл " << inputFile << " расшифрован в " << outputFile << endl;
+    return true;
+}
+
+// Блочный режим: p = 2^521 - 1, в элемент упаковывается (bits(p) - 1) / 8 байтов.
+// Последний блок дополняется байтом 0x80 и нулями (дополнение есть всегда).
+struct BigKey {
+    cpp_int p;
+    cpp_int g;
+    cpp_int x;  // секретный ключ
+    cpp_int d;  // открытый ключ g^x
+    EphemeralPool<cpp_int>::Table gPow, dPow;  // таблицы g^k и d^k, общие для всех файлов
+};
+
+// Секретный ключ блочного режима создаётся при первом запуске и хранится
+// в файле keyFile (десятичное x), дальше только читается.
+bool bigKey(BigKey &key, const string &keyFile = "elgamal_big.key") {
+    key.p = (cpp_int(1) << 521) - 1;
+    key.g = 3;
+    ifstream in(keyFile);
+    if (in) {
+        if (!(in >> key.x) || key.x < 2 || key.x > key.p - 2) {
+            cerr << "Повреждён файл ключа " << keyFile << endl;
+            return false;
+        }
+    } else {
+        DeviceRandom gen;
+        key.x = zi::randomBelow(key.p - 3, gen) + 2;
+        // Файл создаётся сразу с правами 0600: секретный ключ читает только владелец.
+        string text = key.x.str() + "\n";
+        int fd = ::open(keyFile.c_str(), O_WRONLY | O_CREAT | O_EXCL, 0600);
+        bool saved = fd >= 0 && ::write(fd, text.data(), text.size()) == static_cast<ssize_t>(text.size());
+        if (fd >= 0) saved = ::close(fd) == 0 && saved;
+        if (!saved) {
+            cerr << "Не удалось сохранить ключ в " << keyFile << endl;
+            return false;
+        }
+        cout << "Создан новый ключ блочного режима: " << keyFile << endl;
+    }
+    key.d = zi::powMod(key.g, key.x, key.p);
+    key.gPow = make_shared<const zi::FixedBasePow<cpp_int>>(key.g, key.p, cpp_int(key.p - 1));
+    key.dPow = make_shared<const zi::FixedBasePow<cpp_int>>(key.d, key.p, cpp_int(key.p - 1));
+    return true;
+}
+
+uint32_t blockSize(const cpp_int &p) {
+    return static_cast<uint32_t>((zi::bitLength(p) - 1) / 8);
+}
+
+// threads - потоки для пополнения запаса пар (1 внутри пакетного режима,
+// где файлы и так обрабатываются параллельно).
+bool encryptFileBlocks(const string &inputFile, const string &outputFile, const BigKey &key,
+                       unsigned threads = 0) {
+    ifstream in(inputFile, ios::binary);
+    uint32_t blockBytes = blockSize(key.p);
+    CipherWriter out(outputFile, key.p, key.g, blockBytes);
+
+    if (!in.is_open() || !out.ok()) {
+        cerr << "Ошибка открытия файла!" << endl;
+        return false;
+    }
+
+    // Блоков на один больше, чем целых блоков в файле (дополнение есть всегда).
+    in.seekg(0, ios::end);
+    uint64_t blocks = static_cast<uint64_t>(in.tellg()) / blockBytes + 1;
+    in.seekg(0, ios::beg);
+    EphemeralPool<cpp_int, DeviceRandom> pool(key.p, key.gPow, key.dPow,
+                                              static_cast<size_t>(min<uint64_t>(64, blocks)), threads);
+
+    vector<uint8_t> block(blockBytes);
+    bool padded = false;
+    while (!padded) {
+        in.read(reinterpret_cast<char *>(block.data()), blockBytes);
+        size_t count = static_cast<size_t>(in.gcount());
+        if (count < blockBytes) {
+            block[count] = 0x80;
+            fill(block.begin() + count + 1, block.end(), uint8_t(0));
+            padded = true;
+        }
+        cpp_int m = zi::bytesToBig(block.data(), blockBytes);
+        auto [r, dk] = pool.next();
+        out.writePair(r, cpp_int(m * dk % key.p));
+    }
+
+    cout << "Файл " << inputFile << " зашифрован в " << outputFile << endl;
+    return true;
+}
+
+bool decryptFileBlocks(const string &inputFile, const string &outputFile, const BigKey &key) {
+    CipherReader in(inputFile);
+    ofstream out(outputFile, ios::binary);
+
+    if (!in.valid() || !out.is_open()) {
+        cerr << "Ошибка открытия файла!" << endl;
+        return false;
+    }
+    uint32_t blockBytes = blockSize(key.p);
+    if (in.p() != key.p || in.blockBytes() != blockBytes) {
+        cerr << "Файл зашифрован другим ключом или не в блочном режиме" << endl;
+        return false;
+    }
+
+    // Последний блок задерживается, чтобы снять с него дополнение.
+    vector<uint8_t> block(blockBytes), pending;
+    cpp_int exp = key.p - 1 - key.x;
+    cpp_int r, e;
+    while (in.readPair(r, e)) {
+        if (!pending.empty()) out.write(reinterpret_cast<const char *>(pending.data()), pending.size());
+        zi::bigToBytes(cpp_int(e * zi::powMod(r, exp, key.p) % key.p), block.data(), blockBytes);
+        pending = block;
+    }
+    size_t len = pending.size();
+    while (len > 0 && pending[len - 1] == 0) len--;
+    if (len == 0 || pending[len - 1] != 0x80) {
+        cerr << "Повреждён последний блок: " << inputFile << endl;
+        return false;
+    }
+    out.write(reinterpret_cast<const char *>(pending.data()), len - 1);
 
     cout << "Файл " << inputFile << " расшифрован в " << outputFile << endl;
+    return true;
+}
+
+// Пакетный режим: lab_5 batch <манифест> [потоки].
+// Операции: enc, dec (p = 23), enc-block, dec-block (p = 2^521 - 1).
+int runBatch(const string &manifest, unsigned threads,
+             long long p, long long g, long long xB, long long dB) {
+    vector<zi::ManifestJob> jobs;
+    try {
+        jobs = zi::readManifest(manifest);
+    } catch (const exception &e) {
+        cerr << e.what() << endl;
+        return 1;
+    }
+
+    BigKey key;
+    bool needKey = false;
+    for (const auto &job : jobs) needKey = needKey || job.op == "enc-block" || job.op == "dec-block";
+    if (needKey && !bigKey(key)) return 1;
+
+    atomic<size_t> failed{0};
+    auto start = chrono::steady_clock::now();
+    zi::parallelTasks(jobs.size(), threads, [&](size_t i) {
+        const zi::ManifestJob &job = jobs[i];
+        bool ok = false;
+        if (job.op == "enc")
+            ok = encryptFile(job.input, job.output, p, g, dB, 0);
+        else if (job.op == "dec")
+            ok = decryptFile(job.input, job.output, p, xB);
+        else if (job.op == "enc-block")
+            ok = encryptFileBlocks(job.input, job.output, key, 1);
+        else if (job.op == "dec-block")
+            ok = decryptFileBlocks(job.input, job.output, key);
+        else
+            cerr << manifest << ":" << job.line << ": неизвестная операция " << job.op << endl;
+        if (!ok) failed++;
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    cout << "Заданий: " << jobs.size() << ", ошибок: " << failed.load()
+         << ", время: " << seconds << " с" << endl;
+    return failed == 0 ? 0 : 1;
 }
 
-int main() {
+int main(int argc, char *argv[]) {
     long long p = 23;
     long long g = 5;
     long long xB = 13; 
     long long dB = modPow(g, xB, p);
+
+    if (argc >= 3 && string(argv[1]) == "batch") {
+        unsigned threads = argc > 3 ? static_cast<unsigned>(stoul(argv[3])) : 0;
+        return runBatch(argv[2], threads, p, g, xB, dB);
+    }
     
     cout << "p = " << p << ", g = " << g << endl;
     cout << "Секретный ключ B = " << xB << endl;
@@ -72,6 +583,8 @@ int main() {
     cout << "\nВыберите действие:\n";
     cout << "1 - Зашифровать файл\n";
     cout << "2 - Расшифровать файл\n";
+    cout << "3 - Зашифровать файл блоками (p = 2^521 - 1)\n";
+    cout << "4 - Расшифровать файл блоками\n";
     cout << "Ваш выбор: ";
 
     int choice;
@@ -84,7 +597,7 @@ int main() {
         cin >> inFile;
         cout << "Введите имя выходного файла (куда сохранить): ";
         cin >> outFile;
-        cout << "Введите случайное число k (1 < k < p-1): ";
+        cout << "Введите случайное число k (1 < k < p-1, 0 - своё для каждого байта): ";
         cin >> k;
 
         encryptFile(inFile, outFile, p, g, dB, k);
@@ -98,6 +611,20 @@ int main() {
 
         decryptFile(inFile, outFile, p, xB);
     }
+    else if (choice == 3 || choice == 4) {
+        string inFile, outFile;
+        cout << "Введите имя входного файла: ";
+        cin >> inFile;
+        cout << "Введите имя выходного файла: ";
+        cin >> outFile;
+
+        BigKey key;
+        if (!bigKey(key)) return 1;
+        if (choice == 3)
+            encryptFileBlocks(inFile, outFile, key);
+        else
+            decryptFileBlocks(inFile, outFile, key);
+    }
     else {
         cout << "Неверный выбор." << endl;
     }
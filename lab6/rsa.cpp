@@ -1,122 +1,147 @@
 #include <iostream>
 #include <fstream>
+#include <chrono>
 #include <cmath>
+#include <cstdint>
+#include <numeric>
 #include <random>
 #include <vector>
 
-using namespace std;
+#include "../common/modarith.hpp"
+#include "../common/parallel.hpp"
+#include "../common/primes.hpp"
 
-long long modPow(long long base, long long exp, long long mod) {
-    long long result = 1;
-    base %= mod;
-    while (exp > 0) {
-        if (exp & 1)
-            result = (result * base) % mod;
-        base = (base * base) % mod;
-        exp >>= 1;
-    }
-    return result;
-}
-
-bool isPrime(long long n) {
-    if (n < 2) return false;
-    for (long long i = 2; i * i <= n; ++i)
-        if (n % i == 0)
-            return false;
-    return true;
+using namespace std;
+using zi::mulMod;
+using zi::powMod;
+
+// Ключ RSA с параметрами для расшифрования по КТО:
+// dP = d mod (p-1), dQ = d mod (q-1), qInv = q^{-1} mod p.
+struct RsaKey {
+    uint64_t n, e, d;
+    uint64_t p, q, dP, dQ, qInv;
+};
+
+uint64_t generatePrime(mt19937_64 &gen) {
+    return zi::randomPrime(1ULL << 30, (1ULL << 31) - 1, gen);
 }
 
-long long gcd(long long a, long long b) {
-    while (b != 0) {
-        long long t = b;
-        b = a % b;
-        a = t;
-    }
-    return a;
+RsaKey generateKey() {
+    random_device rd;
+    mt19937_64 gen(rd());
+    RsaKey key;
+    do {
+        key.p = generatePrime(gen);
+        key.q = generatePrime(gen);
+    } while (key.p == key.q || gcd(65537ULL, (key.p - 1) * (key.q - 1)) != 1);
+
+    uint64_t phi = (key.p - 1) * (key.q - 1);
+    key.n = key.p * key.q;
+    key.e = 65537;
+    key.d = zi::modInverse(key.e, phi);
+    key.dP = key.d % (key.p - 1);
+    key.dQ = key.d % (key.q - 1);
+    key.qInv = zi::modInverse(key.q, key.p);
+    return key;
 }
 
-long long modInverse(long long a, long long m) {
-    long long m0 = m, t, q;
-    long long x0 = 0, x1 = 1;
-
-    if (m == 1)
-        return 0;
-
-    while (a > 1) {
-        q = a / m;
-        t = m;
-        m = a % m; a = t;
-        t = x0;
-        x0 = x1 - q * x0;
-        x1 = t;
-    }
-
-    if (x1 < 0)
-        x1 += m0;
-
-    return x1;
+// m = c^d mod n через два возведения по модулям вдвое меньшей длины.
+uint64_t decryptCrt(uint64_t c, const RsaKey &key) {
+    uint64_t m1 = powMod(c % key.p, key.dP, key.p);
+    uint64_t m2 = powMod(c % key.q, key.dQ, key.q);
+    uint64_t h = mulMod(key.qInv, (m1 + key.p - m2 % key.p) % key.p, key.p);
+    return m2 + h * key.q;
 }
 
-long long generatePrime() {
-    random_device rd;
-    mt19937 gen(rd());
-    uniform_int_distribution<long long> dist(100, 300);
-    while (true) {
-        long long candidate = dist(gen);
-        if (isPrime(candidate)) return candidate;
-    }
+int bitLength(uint64_t v) {
+    return v == 0 ? 0 : 64 - __builtin_clzll(v);
 }
 
-
-void rsaFile(const string &inputFile, const string &outputFile, long long key, long long n, bool encrypt) {
+// Блок открытого текста - (bits(n) - 1) / 8 байтов (всегда меньше n),
+// элемент шифртекста - ceil(bits(n) / 8) байтов. Шифртекст начинается
+// с 8-байтовой длины исходного файла, последний блок дополняется нулями.
+// Файл читается пачками блоков; блоки пачки считаются параллельно и
+// пишутся по своим смещениям, поэтому порядок на выходе сохраняется.
+void rsaFile(const string &inputFile, const string &outputFile, const RsaKey &key, bool encrypt,
+             unsigned threads = 0) {
     ifstream in(inputFile, ios::binary);
     ofstream out(outputFile, ios::binary);
 
-    unsigned char buffer[2];
-    while (in.read(reinterpret_cast<char *>(buffer), 2)) {
-        long long block = (buffer[0] << 8) | buffer[1];
-        long long processed = modPow(block, key, n);
+    if (!in || !out) {
+        cerr << "Ошибка открытия файлов: " << inputFile << " или " << outputFile << endl;
+        return;
+    }
 
-        unsigned char outBuf[2];
-        outBuf[0] = (processed >> 8) & 0xFF;
-        outBuf[1] = processed & 0xFF;
-        out.write(reinterpret_cast<char *>(outBuf), 2);
+    auto start = chrono::steady_clock::now();
+    const size_t plainBytes = (bitLength(key.n) - 1) / 8;
+    const size_t cipherBytes = (bitLength(key.n) + 7) / 8;
+    const size_t inBytes = encrypt ? plainBytes : cipherBytes;
+    const size_t outBytes = encrypt ? cipherBytes : plainBytes;
+
+    uint64_t length = 0;
+    if (encrypt) {
+        in.seekg(0, ios::end);
+        length = static_cast<uint64_t>(in.tellg());
+        in.seekg(0, ios::beg);
+        out.write(reinterpret_cast<const char *>(&length), sizeof(length));
+    } else if (!in.read(reinterpret_cast<char *>(&length), sizeof(length))) {
+        cerr << "Файл без заголовка: " << inputFile << endl;
+        return;
     }
 
-    if (in.gcount() == 1) {
-        long long block = buffer[0];
-        long long processed = modPow(block, key, n);
-        unsigned char outBuf[2];
-        outBuf[0] = (processed >> 8) & 0xFF;
-        outBuf[1] = processed & 0xFF;
-        out.write(reinterpret_cast<char *>(outBuf), 2);
+    const size_t batchBlocks = 1 << 16;
+    vector<unsigned char> buffer(batchBlocks * inBytes), outBuf(batchBlocks * outBytes);
+    uint64_t blocksLeft = (length + plainBytes - 1) / plainBytes;
+    uint64_t left = length;
+    while (blocksLeft > 0) {
+        size_t blocks = static_cast<size_t>(min<uint64_t>(blocksLeft, batchBlocks));
+        size_t want = encrypt ? static_cast<size_t>(min<uint64_t>(left, blocks * inBytes)) : blocks * inBytes;
+        fill(buffer.begin(), buffer.begin() + blocks * inBytes, 0);
+        if (!in.read(reinterpret_cast<char *>(buffer.data()), want)) {
+            cerr << "Файл обрезан: " << inputFile << endl;
+            return;
+        }
+
+        zi::parallelFor(blocks, threads, [&](size_t begin, size_t end) {
+            for (size_t b = begin; b < end; b++) {
+                uint64_t block = 0;
+                for (size_t i = 0; i < inBytes; i++) block = (block << 8) | buffer[b * inBytes + i];
+                uint64_t processed = encrypt ? powMod(block, key.e, key.n) : decryptCrt(block, key);
+                for (size_t i = outBytes; i-- > 0;) {
+                    outBuf[b * outBytes + i] = processed & 0xFF;
+                    processed >>= 8;
+                }
+            }
+        });
+
+        size_t produced = blocks * outBytes;
+        if (!encrypt) produced = static_cast<size_t>(min<uint64_t>(left, produced));
+        out.write(reinterpret_cast<char *>(outBuf.data()), produced);
+        blocksLeft -= blocks;
+        left -= min<uint64_t>(left, blocks * plainBytes);
     }
 
     in.close();
     out.close();
-}
 
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+    cout << outputFile << ": " << length << " байт, "
+         << (seconds > 0 ? length / seconds / 1e6 : 0.0) << " МБ/с" << endl;
+}
 
 int main() {
-    long long p = generatePrime();
-    long long q = generatePrime();
-    long long n = p * q;
-    long long phi = (p - 1) * (q - 1);
-
-    long long e = 3;
-    while (gcd(e, phi) != 1)
-        e += 2;
-
-    long long d = modInverse(e, phi);
+    RsaKey key = generateKey();
+    uint64_t phi = (key.p - 1) * (key.q - 1);
 
-    cout << "p=" << p << ", q=" << q << endl;
-    cout << "n=" << n << ", phi=" << phi << endl;
-    cout << "open (e=" << e << ", n=" << n << ")\n";
-    cout << "close: (d=" << d << ", n=" << n << ")\n";
+    cout << "p=" << key.p << ", q=" << key.q << endl;
+    cout << "n=" << key.n << ", phi=" << phi << endl;
+    cout << "open (e=" << key.e << ", n=" << key.n << ")\n";
+    cout << "close: (d=" << key.d << ", n=" << key.n << ")\n";
+    cout << "crt: (dP=" << key.dP << ", dQ=" << key.dQ << ", qInv=" << key.qInv << ")\n";
 
-    rsaFile("input.bin", "encrypted.bin", e, n, true);
+    rsaFile("input.bin", "encrypted.bin", key, true);
 
-    rsaFile("encrypted.bin", "decrypted.bin", d, n, false);
+    rsaFile("encrypted.bin", "decrypted.bin", key, false);
 
     return 0;
 }
@@ -5,6 +5,13 @@
 #include <string>
 #include <cmath>
 #include <algorithm>
+#include <atomic>
+#include <chrono>
+#include <exception>
+
+#include "../common/manifest.hpp"
+#include "../common/parallel.hpp"
+#include "../common/primes.hpp"
 
 class VernamCipher {
 private:
@@ -18,15 +25,7 @@ private:
 
     // Проверка числа на простоту
     bool isPrime(int n) {
-        if (n <= 1) return false;
-        if (n <= 3) return true;
-        if (n % 2 == 0 || n % 3 == 0) return false;
-        
-        for (int i = 5; i * i <= n; i += 6) {
-            if (n % i == 0 || n % (i + 2) == 0)
-                return false;
-        }
-        return true;
+        return n > 0 && zi::isPrime(static_cast<std::uint64_t>(n));
     }
 
     // Нахождение первообразного корня по модулю p
@@ -118,19 +117,20 @@ public:
     }
 
     // Шифрование/дешифрование методом Вернама
-    void vernamCipher(const std::string& inputFile, const std::string& outputFile, 
-                     const std::vector<unsigned char>& key) {
+    // keyOffset - с какого байта ключа начинать (каждый байт ключа - один раз)
+    bool vernamCipher(const std::string& inputFile, const std::string& outputFile, 
+                     const std::vector<unsigned char>& key, size_t keyOffset = 0) {
         std::ifstream input(inputFile, std::ios::binary);
         std::ofstream output(outputFile, std::ios::binary);
         
         if (!input) {
             std::cerr << "Ошибка: не удалось открыть входной файл " << inputFile << std::endl;
-                return;
+                return false;
         }
         
         if (!output) {
             std::cerr << "Ошибка: не удалось создать выходной файл " << outputFile << std::endl;
-            return;
+            return false;
         }
         
         // Получаем размер файла
@@ -139,9 +139,9 @@ public:
         input.seekg(0, std::ios::beg);
         
         // Проверяем длину ключа
-        if (key.size() < fileSize) {
+        if (keyOffset > key.size() || key.size() - keyOffset < fileSize) {
             std::cerr << "Ошибка: ключ слишком короткий для файла" << std::endl;
-            return;
+            return false;
         }
         
         // Читаем, шифруем и записываем данные
@@ -149,7 +149,7 @@ public:
         input.read(reinterpret_cast<char*>(buffer.data()), fileSize);
         
         for (size_t i = 0; i < fileSize; i++) {
-            buffer[i] = buffer[i] ^ key[i]; // XOR операция
+            buffer[i] = buffer[i] ^ key[keyOffset + i]; // XOR операция
         }
         
         output.write(reinterpret_cast<char*>(buffer.data()), fileSize);
@@ -158,6 +158,7 @@ public:
         
         input.close();
         output.close();
+        return true;
     }
 
     // Сохранение ключа в файл
@@ -220,10 +221,67 @@ void printMenu() {
     std::cout << "Выберите опцию: ";
 }
 
-int main() {
+// Пакетный режим: lab_7 batch <файл ключа> <манифест> [потоки].
+// Операции enc и dec (для шифра Вернама совпадают); ключ читается один раз.
+// Каждый файл получает свой участок ключа: смещения накапливаются в порядке
+// манифеста, поэтому расшифровывать нужно манифестом с тем же порядком файлов.
+// Если ключ короче всех входных файлов вместе, пакет не выполняется.
+int runBatch(VernamCipher &cipher, const std::string &keyFile, const std::string &manifest,
+             unsigned threads) {
+    std::vector<zi::ManifestJob> jobs;
+    try {
+        jobs = zi::readManifest(manifest);
+    } catch (const std::exception &e) {
+        std::cerr << e.what() << std::endl;
+        return 1;
+    }
+    const std::vector<unsigned char> key = cipher.loadKeyFromFile(keyFile);
+    if (key.empty()) return 1;
+
+    std::vector<size_t> offsets(jobs.size());
+    size_t total = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        const zi::ManifestJob &job = jobs[i];
+        if (job.op != "enc" && job.op != "dec") {
+            std::cerr << manifest << ":" << job.line << ": неизвестная операция " << job.op << std::endl;
+            return 1;
+        }
+        std::ifstream input(job.input, std::ios::binary | std::ios::ate);
+        if (!input) {
+            std::cerr << "Ошибка: не удалось открыть входной файл " << job.input << std::endl;
+            return 1;
+        }
+        offsets[i] = total;
+        total += static_cast<size_t>(input.tellg());
+    }
+    if (total > key.size()) {
+        std::cerr << "Ошибка: ключ (" << key.size() << " байт) короче всех файлов пакета ("
+                  << total << " байт)" << std::endl;
+        return 1;
+    }
+
+    std::atomic<size_t> failed{0};
+    auto start = std::chrono::steady_clock::now();
+    zi::parallelTasks(jobs.size(), threads, [&](size_t i) {
+        const zi::ManifestJob &job = jobs[i];
+        if (!cipher.vernamCipher(job.input, job.output, key, offsets[i])) failed++;
+    });
+    double seconds = std::chrono::duration<double>(std::chrono::steady_clock::now() - start).count();
+
+    std::cout << "Заданий: " << jobs.size() << ", ошибок: " << failed.load()
+              << ", время: " << seconds << " с" << std::endl;
+    return failed == 0 ? 0 : 1;
+}
+
+int main(int argc, char *argv[]) {
     VernamCipher cipher;
     std::vector<unsigned char> currentKey;
     std::string currentKeyType = "нет";
+
+    if (argc >= 4 && std::string(argv[1]) == "batch") {
+        unsigned threads = argc > 4 ? static_cast<unsigned>(std::stoul(argv[4])) : 0;
+        return runBatch(cipher, argv[2], argv[3], threads);
+    }
     
     setlocale(LC_ALL, "Russian");
     
@@ -1,30 +1,40 @@
 #include <iostream>
+#include <atomic>
+#include <chrono>
+#include <filesystem>
 #include <fstream>
 #include <vector>
 #include <random>
-#include <openssl/sha.h>
 #include <iomanip>
+#include <cstring>
+#include <stdexcept>
+#include <string>
+
+#include <openssl/rand.h>
+
+#include "../common/batch_pow.hpp"
+#include "../common/bigint.hpp"
+#include "../common/file_hash.hpp"
+#include "../common/manifest.hpp"
+#include "../common/mapped_file.hpp"
+#include "../common/modarith.hpp"
+#include "../common/parallel.hpp"
+#include "../common/primes.hpp"
 
 using namespace std;
+using zi::cpp_int;
 
-class RSA {
+// Ключи создаются только командой gen; sign и verify их загружают.
+// Двоичный файл ключа хранит также параметры КТО (dP, dQ, qInv): подпись
+// считается по модулям p и q, загрузка - mmap и проверка полей.
+// Имя RSA занято typedef из заголовков OpenSSL (openssl/types.h).
+class SmallRSA {
 public:
-    uint64_t p, q, n, phi, e, d;
-
-    RSA() {
-        generateKeys();
-    }
+    uint64_t p = 0, q = 0, n = 0, phi = 0, e = 0, d = 0;
+    uint64_t dP = 0, dQ = 0, qInv = 0;
 
     static uint64_t modPow(uint64_t base, uint64_t exp, uint64_t mod) {
-        uint64_t res = 1 % mod;
-        base %= mod;
-        while (exp) {
-            if (exp & 1)
-                res = (__uint128_t)res * base % mod;
-            base = (__uint128_t)base * base % mod;
-            exp >>= 1;
-        }
-        return res;
+        return zi::powMod(base, exp, mod);
     }
 
     static uint64_t gcd(uint64_t a, uint64_t b) {
@@ -37,12 +47,7 @@ public:
     }
 
     static int64_t egcd(int64_t a, int64_t b, int64_t &x, int64_t &y) {
-        if (b == 0) { x = 1; y = 0; return a; }
-        int64_t x1, y1;
-        int64_t g = egcd(b, a % b, x1, y1);
-        x = y1;
-        y = x1 - (a / b) * y1;
-        return g;
+        return zi::extendedGCD(a, b, x, y);
     }
 
     static uint64_t modInverse(uint64_t a, uint64_t m) {
@@ -55,21 +60,13 @@ public:
     }
 
     static bool isPrime(uint64_t n) {
-        if (n < 2) return false;
-        for (uint64_t i = 2; i * i <= n; ++i)
-            if (n % i == 0)
-                return false;
-        return true;
+        return zi::isPrime(n);
     }
 
     static uint64_t randomPrime(uint64_t low = 1000, uint64_t high = 10000) {
         random_device rd;
         mt19937 gen(rd());
-        uniform_int_distribution<uint64_t> dist(low, high);
-        while (true) {
-            uint64_t x = dist(gen);
-            if (isPrime(x)) return x;
-        }
+        return zi::randomPrime(low, high, gen);
     }
 
     void generateKeys() {
@@ -81,6 +78,9 @@ public:
         while (gcd(e, phi) != 1)
             e += 2;
         d = modInverse(e, phi);
+        dP = d % (p - 1);
+        dQ = d % (q - 1);
+        qInv = modInverse(q, p);
     }
 
     uint64_t signByte(uint8_t b) const {
@@ -91,6 +91,24 @@ public:
         return (uint8_t)modPow(s, e, n);
     }
 
+    // По КТО, если известны p и q (текстовый закрытый ключ хранит только d, n).
+    vector<uint64_t> signBytes(const vector<uint8_t> &bytes) const {
+        vector<uint64_t> values(bytes.begin(), bytes.end());
+        if (p == 0 || q == 0) return zi::batchModPow(values, d, n);
+        auto m1 = zi::batchModPow(values, dP, p);
+        auto m2 = zi::batchModPow(values, dQ, q);
+        for (size_t i = 0; i < values.size(); i++) {
+            uint64_t h = zi::mulMod(qInv, (m1[i] + p - m2[i] % p) % p, p);
+            values[i] = m2[i] + h * q;
+        }
+        return values;
+    }
+
+    vector<uint8_t> verifyBytes(const vector<uint64_t> &sigs) const {
+        auto values = zi::batchModPow(sigs, e, n);
+        return vector<uint8_t>(values.begin(), values.end());
+    }
+
     void saveKeys(const string &pubFile, const string &privFile) const {
         ofstream pub(pubFile);
         pub << e << " " << n;
@@ -107,49 +125,284 @@ public:
         ifstream in(file);
         in >> d >> n;
     }
+
+    void saveBinary(const string &file, bool withPrivate) const {
+        KeyFile k{};
+        memcpy(k.magic, keyMagic, sizeof(k.magic));
+        k.hasPrivate = withPrivate ? 1 : 0;
+        k.n = n;
+        k.e = e;
+        if (withPrivate) {
+            k.d = d;
+            k.p = p;
+            k.q = q;
+            k.dP = dP;
+            k.dQ = dQ;
+            k.qInv = qInv;
+        }
+        ofstream out(file, ios::binary);
+        out.write(reinterpret_cast<const char *>(&k), sizeof(k));
+        if (!out) throw runtime_error("Не удалось записать " + file);
+    }
+
+    void loadBinary(const string &file, bool needPrivate) {
+        zi::MappedFile mapped(file);
+        KeyFile k;
+        if (mapped.size() != sizeof(k)) throw runtime_error("Неверный размер файла ключа " + file);
+        memcpy(&k, mapped.data(), sizeof(k));
+        bool valid = memcmp(k.magic, keyMagic, sizeof(k.magic)) == 0 && k.n > 1 && k.e > 1 && k.e < k.n;
+        if (valid && k.hasPrivate) {
+            valid = k.p > 1 && k.q > 1 && k.p * k.q == k.n && k.d < k.n &&
+                    k.dP == k.d % (k.p - 1) && k.dQ == k.d % (k.q - 1) && k.qInv < k.p;
+        }
+        // qInv - обратный к q по модулю p, e*d = 1 (mod lcm(p-1, q-1)):
+        // иначе подпись по КТО молча выходила бы неверной.
+        if (valid && k.hasPrivate) {
+            uint64_t lambda = (k.p - 1) / gcd(k.p - 1, k.q - 1) * (k.q - 1);
+            valid = zi::mulMod(k.q % k.p, k.qInv, k.p) == 1 && zi::mulMod(k.e % lambda, k.d, lambda) == 1;
+        }
+        if (!valid || (needPrivate && !k.hasPrivate)) throw runtime_error("Повреждён файл ключа " + file);
+
+        n = k.n;
+        e = k.e;
+        d = k.d;
+        p = k.p;
+        q = k.q;
+        phi = k.hasPrivate ? (p - 1) * (q - 1) : 0;
+        dP = k.dP;
+        dQ = k.dQ;
+        qInv = k.qInv;
+    }
+
+private:
+    struct KeyFile {
+        char magic[8];
+        uint32_t hasPrivate;
+        uint32_t reserved;
+        uint64_t n, e, d, p, q, dP, dQ, qInv;
+    };
+    static constexpr char keyMagic[8] = {'Z', 'I', 'R', 'S', 'A', 'K', '0', '2'};
+};
+
+// Двоичный ключ, если он есть, иначе текстовый.
+void loadKey(SmallRSA &rsa, bool privateKey) {
+    string binary = privateKey ? "private.bin" : "public.bin";
+    if (ifstream(binary).good()) {
+        rsa.loadBinary(binary, privateKey);
+    } else if (privateKey) {
+        rsa.loadPrivate("private.key");
+    } else {
+        rsa.loadPublic("public.key");
+    }
+}
+
+// Криптостойкий генератор для простых чисел ключа: 64 бита из RAND_bytes
+// на каждый вызов (подходит как UniformRandomBitGenerator).
+struct SecureRandom {
+    using result_type = uint64_t;
+    static constexpr result_type min() { return 0; }
+    static constexpr result_type max() { return ~result_type(0); }
+
+    result_type operator()() {
+        result_type v;
+        if (RAND_bytes(reinterpret_cast<unsigned char *>(&v), sizeof(v)) != 1) {
+            throw runtime_error("RAND_bytes: нет энтропии");
+        }
+        return v;
+    }
 };
 
-vector<uint8_t> sha256(const string &filename) {
-    ifstream file(filename, ios::binary);
-    if (!file) throw runtime_error("Не удалось открыть файл для хеша");
+// RSA с многоразрядным модулем (2048/3072 бит): весь SHA-256 подписывается
+// одним возведением в степень. Дайджест кодируется как в PKCS#1 v1.5
+// (00 01 FF..FF 00 DigestInfo хеш), закрытая операция идёт по КТО.
+class BigRSA {
+public:
+    cpp_int n, e, d, p, q, dP, dQ, qInv;
 
-    SHA256_CTX ctx;
-    SHA256_Init(&ctx);
+    void generateKeys(size_t bits = 2048) {
+        SecureRandom gen;
+        e = 65537;
+        do {
+            p = zi::randomBigPrime(bits / 2, gen);
+            q = zi::randomBigPrime(bits - bits / 2, gen);
+        } while (p == q || (p - 1) % e == 0 || (q - 1) % e == 0);
+        if (p < q) swap(p, q);
+        n = p * q;
+        d = zi::modInverse(e, cpp_int((p - 1) * (q - 1)));
+        dP = d % (p - 1);
+        dQ = d % (q - 1);
+        qInv = zi::modInverse(q, p);
+    }
+
+    size_t modulusBytes() const { return zi::byteLength(n); }
+
+    vector<uint8_t> sign(const vector<uint8_t> &digest) const {
+        cpp_int m = zi::bytesToBig(encode(digest).data(), modulusBytes());
+        cpp_int m1 = zi::powMod(cpp_int(m % p), dP, p);
+        cpp_int m2 = zi::powMod(cpp_int(m % q), dQ, q);
+        cpp_int h = qInv * (m1 + p - m2 % p) % p;
+        vector<uint8_t> sig(modulusBytes());
+        zi::bigToBytes(m2 + h * q, sig.data(), sig.size());
+        return sig;
+    }
 
-    vector<unsigned char> buf(4096);
-    while (file) {
-        file.read((char*)buf.data(), buf.size());
-        SHA256_Update(&ctx, buf.data(), file.gcount());
+    bool verify(const vector<uint8_t> &digest, const vector<uint8_t> &sig) const {
+        if (sig.size() != modulusBytes()) return false;
+        cpp_int s = zi::bytesToBig(sig.data(), sig.size());
+        if (s >= n) return false;
+        vector<uint8_t> em(modulusBytes());
+        zi::bigToBytes(zi::powMod(s, e, n), em.data(), em.size());
+        return em == encode(digest);
     }
 
-    vector<uint8_t> hash(SHA256_DIGEST_LENGTH);
-    SHA256_Final(hash.data(), &ctx);
-    return hash;
+    void saveKeys(const string &pubFile, const string &privFile) const {
+        ofstream pub(pubFile);
+        pub << e << " " << n;
+        ofstream priv(privFile);
+        priv << n << " " << e << " " << d << " " << p << " " << q << " "
+             << dP << " " << dQ << " " << qInv;
+    }
+
+    void loadPublic(const string &file) {
+        ifstream in(file);
+        if (!(in >> e >> n)) throw runtime_error("Не удалось прочитать " + file);
+    }
+
+    void loadPrivate(const string &file) {
+        ifstream in(file);
+        if (!(in >> n >> e >> d >> p >> q >> dP >> dQ >> qInv)) {
+            throw runtime_error("Не удалось прочитать " + file);
+        }
+    }
+
+private:
+    vector<uint8_t> encode(const vector<uint8_t> &digest) const {
+        static const uint8_t digestInfo[] = {0x30, 0x31, 0x30, 0x0d, 0x06, 0x09, 0x60, 0x86, 0x48, 0x01,
+                                             0x65, 0x03, 0x04, 0x02, 0x01, 0x05, 0x00, 0x04, 0x20};
+        size_t k = modulusBytes();
+        size_t tLen = sizeof(digestInfo) + digest.size();
+        if (k < tLen + 11) throw runtime_error("Модуль слишком мал для подписи");
+        vector<uint8_t> em(k, 0xFF);
+        em[0] = 0x00;
+        em[1] = 0x01;
+        em[k - tLen - 1] = 0x00;
+        copy(begin(digestInfo), end(digestInfo), em.begin() + (k - tLen));
+        copy(digest.begin(), digest.end(), em.end() - digest.size());
+        return em;
+    }
+};
+
+vector<uint8_t> sha256(const string &filename) {
+    return zi::sha256File(filename);
+}
+
+// Размер только для обычных файлов: повторное открытие канала заблокировалось бы.
+uint64_t regularFileSize(const string &filename) {
+    error_code ec;
+    if (!filesystem::is_regular_file(filename, ec)) return 0;
+    auto size = filesystem::file_size(filename, ec);
+    return ec ? 0 : static_cast<uint64_t>(size);
 }
 
-void signFile(const string &infile, const string &sigfile, const RSA &rsa) {
+void signFile(const string &infile, const string &sigfile, const SmallRSA &rsa) {
     auto hash = sha256(infile);
+    auto sigs = rsa.signBytes(hash);
     ofstream out(sigfile, ios::binary);
-    for (auto b : hash) {
-        uint64_t s = rsa.signByte(b);
-        out.write((char*)&s, sizeof(s));
-    }
+    out.write((char*)sigs.data(), sigs.size() * sizeof(uint64_t));
     cout << "Подпись сохранена в " << sigfile << endl;
 }
 
-bool verifyFile(const string &infile, const string &sigfile, const RSA &rsa) {
+bool verifyFile(const string &infile, const string &sigfile, const SmallRSA &rsa) {
     auto hash = sha256(infile);
     ifstream in(sigfile, ios::binary);
     if (!in) throw runtime_error("Не удалось открыть подпись");
 
-    for (size_t i = 0; i < hash.size(); ++i) {
-        uint64_t s;
-        in.read((char*)&s, sizeof(s));
-        if (!in) return false;
-        uint8_t orig = rsa.verifyByte(s);
-        if (orig != hash[i]) return false;
+    vector<uint64_t> sigs(hash.size());
+    in.read((char*)sigs.data(), sigs.size() * sizeof(uint64_t));
+    if (!in) return false;
+    return rsa.verifyBytes(sigs) == hash;
+}
+
+void signFileBig(const string &infile, const string &sigfile, const BigRSA &rsa) {
+    auto sig = rsa.sign(sha256(infile));
+    ofstream out(sigfile, ios::binary);
+    out.write((char*)sig.data(), sig.size());
+    cout << "Подпись сохранена в " << sigfile << endl;
+}
+
+bool verifyFileBig(const string &infile, const string &sigfile, const BigRSA &rsa) {
+    auto hash = sha256(infile);
+    ifstream in(sigfile, ios::binary);
+    if (!in) throw runtime_error("Не удалось открыть подпись");
+
+    vector<uint8_t> sig(rsa.modulusBytes());
+    in.read((char*)sig.data(), sig.size());
+    if (!in || in.peek() != EOF) return false;
+    return rsa.verify(hash, sig);
+}
+
+// Пакетная проверка: строки манифеста "verify <файл> <sig>" или
+// "verify-mp <файл> <sig>". Ключи читаются один раз; одновременно
+// обрабатывается не больше threads файлов.
+int verifyBatch(const string &manifest, unsigned threads) {
+    vector<zi::ManifestJob> jobs;
+    SmallRSA rsa;
+    BigRSA big;
+    try {
+        jobs = zi::readManifest(manifest);
+        bool needSmall = false, needBig = false;
+        for (const auto &job : jobs) {
+            needSmall = needSmall || job.op == "verify";
+            needBig = needBig || job.op == "verify-mp";
+        }
+        if (needSmall) loadKey(rsa, false);
+        if (needBig) big.loadPublic("public_mp.key");
+    } catch (const exception &e) {
+        cerr << "Ошибка: " << e.what() << endl;
+        return 1;
     }
-    return true;
+
+    enum Result { Valid, Invalid, Error };
+    vector<Result> results(jobs.size(), Error);
+    vector<string> errors(jobs.size());
+    atomic<uint64_t> bytes{0};
+    auto start = chrono::steady_clock::now();
+    zi::parallelTasks(jobs.size(), threads, [&](size_t i) {
+        const zi::ManifestJob &job = jobs[i];
+        try {
+            bool ok;
+            if (job.op == "verify")
+                ok = verifyFile(job.input, job.output, rsa);
+            else if (job.op == "verify-mp")
+                ok = verifyFileBig(job.input, job.output, big);
+            else
+                throw runtime_error("неизвестная операция " + job.op);
+            results[i] = ok ? Valid : Invalid;
+            bytes += regularFileSize(job.input);
+        } catch (const exception &e) {
+            errors[i] = e.what();
+        }
+    });
+    double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+
+    size_t valid = 0, invalid = 0, failed = 0;
+    for (size_t i = 0; i < jobs.size(); i++) {
+        if (results[i] == Valid) {
+            valid++;
+            cout << "OK    " << jobs[i].input << "\n";
+        } else if (results[i] == Invalid) {
+            invalid++;
+            cout << "FAIL  " << jobs[i].input << "\n";
+        } else {
+            failed++;
+            cout << "ERROR " << jobs[i].input << ": " << errors[i] << "\n";
+        }
+    }
+    cout << "Файлов: " << jobs.size() << ", верных: " << valid << ", неверных: " << invalid
+         << ", ошибок: " << failed << "\n"
+         << "Время: " << seconds << " с, " << (seconds > 0 ? jobs.size() / seconds : 0.0) << " файлов/с, "
+         << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << " ГБ/с" << endl;
+    return invalid == 0 && failed == 0 ? 0 : 1;
 }
 
 int main(int argc, char *argv[]) {
@@ -157,26 +410,59 @@ int main(int argc, char *argv[]) {
         cout << "Использование:\n"
              << "  rsa_sign gen                      — создать ключи\n"
              << "  rsa_sign sign <файл> <sig>        — подписать файл\n"
-             << "  rsa_sign verify <файл> <sig>      — проверить подпись\n";
+             << "  rsa_sign verify <файл> <sig>      — проверить подпись\n"
+             << "  rsa_sign verify-batch <манифест> [потоки] — проверить много подписей\n"
+             << "  rsa_sign hash <файл>              — SHA-256 и скорость хеширования\n"
+             << "  rsa_sign gen-mp [биты]            — создать ключи 2048/3072 бит\n"
+             << "  rsa_sign sign-mp <файл> <sig>     — подписать весь дайджест\n"
+             << "  rsa_sign verify-mp <файл> <sig>   — проверить такую подпись\n";
         return 0;
     }
 
     string cmd = argv[1];
-    RSA rsa;
+    SmallRSA rsa;
 
     try {
         if (cmd == "gen") {
             rsa.generateKeys();
             rsa.saveKeys("public.key", "private.key");
-            cout << "Ключи сохранены:\n public.key (e,n)\n private.key (d,n)\n";
+            rsa.saveBinary("public.bin", false);
+            rsa.saveBinary("private.bin", true);
+            cout << "Ключи сохранены:\n public.key (e,n)\n private.key (d,n)\n"
+                 << " public.bin, private.bin (с параметрами КТО)\n";
             cout << "p=" << rsa.p << " q=" << rsa.q << " n=" << rsa.n << "\n";
         } else if (cmd == "sign" && argc == 4) {
-            rsa.loadPrivate("private.key");
+            loadKey(rsa, true);
             signFile(argv[2], argv[3], rsa);
         } else if (cmd == "verify" && argc == 4) {
-            rsa.loadPublic("public.key");
+            loadKey(rsa, false);
             bool ok = verifyFile(argv[2], argv[3], rsa);
             cout << (ok ? "Подпись ВЕРНА ✅" : "Подпись НЕВЕРНА ❌") << endl;
+        } else if (cmd == "verify-batch" && (argc == 3 || argc == 4)) {
+            return verifyBatch(argv[2], argc == 4 ? static_cast<unsigned>(stoul(argv[3])) : 0);
+        } else if (cmd == "hash" && argc == 3) {
+            auto start = chrono::steady_clock::now();
+            auto hash = sha256(argv[2]);
+            double seconds = chrono::duration<double>(chrono::steady_clock::now() - start).count();
+            double bytes = static_cast<double>(regularFileSize(argv[2]));
+            for (uint8_t b : hash) cout << hex << setw(2) << setfill('0') << int(b);
+            cout << dec << "  " << argv[2] << "\n"
+                 << fixed << setprecision(2) << (seconds > 0 ? bytes / seconds / 1e9 : 0.0) << " ГБ/с" << endl;
+        } else if (cmd == "gen-mp" && argc <= 3) {
+            BigRSA big;
+            big.generateKeys(argc == 3 ? stoul(argv[2]) : 2048);
+            big.saveKeys("public_mp.key", "private_mp.key");
+            cout << "Ключи сохранены:\n public_mp.key (e,n)\n private_mp.key (n,e,d,p,q,dP,dQ,qInv)\n";
+            cout << "Длина модуля: " << zi::bitLength(big.n) << " бит\n";
+        } else if (cmd == "sign-mp" && argc == 4) {
+            BigRSA big;
+            big.loadPrivate("private_mp.key");
+            signFileBig(argv[2], argv[3], big);
+        } else if (cmd == "verify-mp" && argc == 4) {
+            BigRSA big;
+            big.loadPublic("public_mp.key");
+            bool ok = verifyFileBig(argv[2], argv[3], big);
+            cout << (ok ? "Подпись ВЕРНА ✅" : "Подпись НЕВЕРНА ❌") << endl;
         } else {
             cerr << "Неверные аргументы\n";
         }
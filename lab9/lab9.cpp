@@ -6,25 +6,21 @@
 #include <openssl/md5.h>
 #include <openssl/sha.h>
 
+#include "../common/batch_pow.hpp"
+#include "../common/file_hash.hpp"
+#include "../common/fixed_base.hpp"
+#include "../common/modarith.hpp"
+
 class ElGamalSignature {
 private:
     long long p;  
     long long g; 
     long long x; 
     long long y; 
+    zi::FixedBasePow<std::uint64_t> g_pow;
 
     long long mod_pow(long long base, long long exponent, long long modulus) {
-        long long result = 1;
-        base = base % modulus;
-        
-        while (exponent > 0) {
-            if (exponent % 2 == 1) {
-                result = (result * base) % modulus;
-            }
-            exponent = exponent >> 1;
-            base = (base * base) % modulus;
-        }
-        return result;
+        return zi::modPow(base, exponent, modulus);
     }
 
     long long gcd(long long a, long long b) {
@@ -37,17 +33,7 @@ private:
     }
 
     long long extended_gcd(long long a, long long b, long long& x, long long& y) {
-        if (b == 0) {
-            x = 1;
-            y = 0;
-            return a;
-        }
-        
-        long long x1, y1;
-        long long d = extended_gcd(b, a % b, x1, y1);
-        x = y1;
-        y = x1 - y1 * (a / b);
-        return d;
+        return zi::extendedGCD(a, b, x, y);
     }
 
     long long mod_inverse(long long a, long long m) {
@@ -60,21 +46,18 @@ private:
     }
 
 public:
-    ElGamalSignature() {
-        p = 30803;  
-        g = 2;
-        
+    ElGamalSignature() : p(30803), g(2), g_pow(g, p, p - 1) {
         std::random_device rd;
         std::mt19937 gen(rd());
         std::uniform_int_distribution<long long> dis(2, p - 2);
         x = dis(gen);
         
-        y = mod_pow(g, x, p);
+        y = g_pow.pow(x);
     }
 
     ElGamalSignature(long long p_val, long long g_val, long long x_val) 
-        : p(p_val), g(g_val), x(x_val) {
-        y = mod_pow(g, x, p);
+        : p(p_val), g(g_val), x(x_val), g_pow(g_val, p_val, p_val - 1) {
+        y = g_pow.pow(x);
     }
 
     std::vector<long long> get_public_key() {
@@ -87,43 +70,46 @@ public:
         return hash;
     }
 
-    std::vector<std::pair<long long, long long>> sign_file(const std::string& filename) {
-        std::ifstream file(filename, std::ios::binary);
-        if (!file) {
+    // Потоковый хеш: файл читается через mmap или большими блоками,
+    // память не зависит от размера файла.
+    std::vector<unsigned char> compute_file_hash(const std::string& filename) {
+        try {
+            return zi::sha256File(filename);
+        } catch (const std::runtime_error&) {
             throw std::runtime_error("Не удалось открыть файл: " + filename);
         }
-        
-        std::vector<unsigned char> file_data(
-            (std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>()
-        );
-        file.close();
+    }
 
-        std::vector<unsigned char> hash = compute_hash(file_data);
+    std::vector<std::pair<long long, long long>> sign_file(const std::string& filename) {
+        std::vector<unsigned char> hash = compute_file_hash(filename);
         
         std::vector<std::pair<long long, long long>> signature;
         
-        for (unsigned char byte : hash) {
-            long long m = static_cast<long long>(byte);
-            
-            std::random_device rd;
-            std::mt19937 gen(rd());
-            std::uniform_int_distribution<long long> dis(2, p - 2);
-            
-            long long k;
+        std::random_device rd;
+        std::mt19937 gen(rd());
+        std::uniform_int_distribution<long long> dis(2, p - 2);
+
+        std::vector<std::uint64_t> ks(hash.size());
+        for (auto& k : ks) {
             do {
                 k = dis(gen);
             } while (gcd(k, p - 1) != 1);
-            
-            long long r = mod_pow(g, k, p);
-            
-            long long k_inv = mod_inverse(k, p - 1);
+        }
+        std::vector<std::uint64_t> k_invs = zi::batchModInverse(ks, p - 1);
+
+        for (size_t i = 0; i < hash.size(); i++) {
+            long long m = static_cast<long long>(hash[i]);
+            long long k = static_cast<long long>(ks[i]);
+
+            long long r = g_pow.pow(k);
+
+            long long k_inv = static_cast<long long>(k_invs[i]);
             long long s = (k_inv * (m - x * r)) % (p - 1);
             if (s < 0) s += (p - 1);
-            
+
             signature.push_back({r, s});
         }
-        
+
         return signature;
     }
 
@@ -138,25 +124,14 @@ public:
         long long g_verify = public_key[1];
         long long y_verify = public_key[2];
         
-        std::ifstream file(filename, std::ios::binary);
-        if (!file) {
-            throw std::runtime_error("Не удалось открыть файл: " + filename);
-        }
-        
-        std::vector<unsigned char> file_data(
-            (std::istreambuf_iterator<char>(file)),
-            std::istreambuf_iterator<char>()
-        );
-        file.close();
-
-        std::vector<unsigned char> hash = compute_hash(file_data);
+        std::vector<unsigned char> hash = compute_file_hash(filename);
         
         if (hash.size() != signature.size()) {
             return false;
         }
         
+        std::vector<std::uint64_t> ms(hash.size()), rs(hash.size()), ss(hash.size());
         for (size_t i = 0; i < hash.size(); i++) {
-            long long m = static_cast<long long>(hash[i]);
             long long r = signature[i].first;
             long long s = signature[i].second;
             
@@ -164,10 +139,17 @@ public:
                 return false;
             }
             
-            long long left = mod_pow(g_verify, m, p_verify);
-            long long right = (mod_pow(y_verify, r, p_verify) * mod_pow(r, s, p_verify)) % p_verify;
-            
-            if (left != right) {
+            ms[i] = hash[i];
+            rs[i] = r;
+            ss[i] = s;
+        }
+
+        std::vector<std::uint64_t> left = zi::batchModPow(std::vector<std::uint64_t>(hash.size(), g_verify), ms, p_verify);
+        std::vector<std::uint64_t> y_r = zi::batchModPow(std::vector<std::uint64_t>(hash.size(), y_verify), rs, p_verify);
+        std::vector<std::uint64_t> r_s = zi::batchModPow(rs, ss, p_verify);
+        
+        for (size_t i = 0; i < hash.size(); i++) {
+            if (left[i] != zi::mulMod(y_r[i], r_s[i], p_verify)) {
                 return false;
             }
         }